@@ -29,9 +29,24 @@ unsigned long now_us() {
    return ((unsigned long) _sys_timer.read_time());
 }
 
-// current system time in ms
+// current system time in clock cycles
+uint64_t now_tick() {
+   return (_sys_timer.read_tick());
+}
+
+// select the event captured by the system timer
+void capture_select(int src) {
+   _sys_timer.set_capture(src);
+}
+
+// clock count (32 LSBs) at the last capture event
+uint32_t capture_tick() {
+   return (_sys_timer.read_capture_lower());
+}
+
+// current system time in ms (one divide)
 unsigned long now_ms() {
-   return ((unsigned long) _sys_timer.read_time() / 1000);
+   return ((unsigned long) (_sys_timer.read_tick() / (SYS_CLK_FREQ * 1000)));
 }
 
 // idle for t microseconds
@@ -39,6 +54,11 @@ void sleep_us(unsigned long int t) {
    _sys_timer.sleep(uint64_t(t));
 }
 
+// idle until the system clock count reaches tick
+void sleep_until_tick(uint64_t tick) {
+   _sys_timer.sleep_until(tick);
+}
+
 // idle for t ms
 void sleep_ms(unsigned long int t) {
    _sys_timer.sleep(uint64_t(1000 * t));
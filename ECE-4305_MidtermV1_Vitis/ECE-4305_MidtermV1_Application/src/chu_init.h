@@ -50,6 +50,21 @@ extern "C" {
  */
 unsigned long now_us();
 
+/**
+ * Current system "up time" in clock cycles (SYS_CLK_FREQ MHz).
+ */
+uint64_t now_tick();
+
+/**
+ * Select the event captured by the system timer (TimerCore::CAP_*).
+ */
+void capture_select(int src);
+
+/**
+ * 32 LSBs of the clock count at the last capture event.
+ */
+uint32_t capture_tick();
+
 /**
  * Current system "up time" in millisecond.
  */
@@ -67,6 +82,12 @@ void sleep_us(unsigned long int t);
  */
 void sleep_ms(unsigned long int t);
 
+/**
+ * idle until the system clock count reaches tick.
+ * @param tick clock count (see now_tick())
+ */
+void sleep_until_tick(uint64_t tick);
+
 
 /**********************************************************************
  * debug(): function to facilitate debugging
@@ -34,6 +34,9 @@ extern "C" {
 //io base address for microBlaze MCS
 #define BRIDGE_BASE 0xc0000000
 
+//io module (interrupt controller) base address for microBlaze MCS
+#define IOMODULE_BASE 0x80000000
+
 // slot module definition
 // format: Slot#_ModuleType_Name
 #define S0_SYS_TIMER  0
@@ -50,6 +53,7 @@ extern "C" {
 #define S11_PS2      11
 #define S12_DDFS     12
 #define S13_ADSR     13
+#define S14_TOF_ACQ  14
 
 // video module definition
 #define V0_SYNC      0
@@ -44,6 +44,9 @@ extern "C" {
 #define io_write(base_addr, offset, data) \
    (*(volatile uint32_t *)((base_addr) + 4*(offset)) = (data))
 
+#else
+// vendor/emulation backend (e.g., host build: ../../host/vendor_io.h)
+#include "vendor_io.h"
 #endif  // _VENDOR_IO_ACCESS_USED
 /**
  * calculate base address of a memory mapped io slot.
@@ -12,20 +12,61 @@
 /* methods */
 I2cCore::I2cCore(uint32_t core_base_addr) {
    base_addr = core_base_addr;
+   cur = 0;
    set_freq(100000);  // default 100K Hz
 }
 I2cCore::~I2cCore() {
 }                  // not used
 
 void I2cCore::set_freq(int freq) {
-   uint32_t dvsr;
+   uint32_t tlow, min_dvsr;
 
    // 25% of i2c period = (1/freq)/4; sys clock period = 1/f_sys
    // dvsr = # sys clocks =  ((1/freq)/4)/(1/f_sys) = f_sys/freq/4
-   dvsr = (uint32_t) (SYS_CLK_FREQ * 1000000 / freq / 4);
+   // (rounded up so sclk never exceeds freq)
+   dvsr = (uint32_t) ((SYS_CLK_FREQ * 1000000 + 4 * freq - 1) / (4 * freq));
+   // scl low phase is 2*dvsr clocks; keep it above the mode's minimum
+   if (freq <= 100000)
+      tlow = SM_TLOW_NS;
+   else if (freq <= 400000)
+      tlow = FM_TLOW_NS;
+   else
+      tlow = FMP_TLOW_NS;
+   min_dvsr = (tlow * SYS_CLK_FREQ + 1999) / 2000;
+   if (dvsr < min_dvsr)
+      dvsr = min_dvsr;
    io_write(base_addr, DVSR_REG, dvsr);
 }
 
+int I2cCore::get_freq() {
+   return ((int) (SYS_CLK_FREQ * 1000000 / (4 * dvsr)));
+}
+
+int I2cCore::probe_freq(uint8_t dev, uint8_t reg, int trials) {
+   static const int freqs[] = {1000000, 400000};
+   uint8_t ref[PROBE_LEN], bytes[PROBE_LEN];
+   int i, j, t, ok;
+
+   set_freq(100000);
+   if (write_read_transaction(dev, &reg, 1, ref, PROBE_LEN) != 0)
+      return (-1);
+   for (i = 0; i < (int) (sizeof(freqs) / sizeof(freqs[0])); i++) {
+      set_freq(freqs[i]);
+      ok = 1;
+      for (t = 0; t < trials && ok; t++) {
+         if (write_read_transaction(dev, &reg, 1, bytes, PROBE_LEN) != 0)
+            ok = 0;
+         for (j = 0; j < PROBE_LEN && ok; j++)
+            if (bytes[j] != ref[j])
+               ok = 0;
+      }
+      if (ok)
+         return (get_freq());
+   }
+   set_freq(100000);
+   return (get_freq());
+}
+
 int I2cCore::ready() {
    return ((int) (io_read(base_addr,RD_REG) >> 8) & 0x01);
 }
@@ -80,46 +121,160 @@ int I2cCore::read_byte(int last) {
 }
 
 
-int I2cCore::read_transaction(uint8_t dev, uint8_t *bytes, int num,
-      int rstart) {
-   uint8_t dev_byte;
-   int ack1;
-   int i;
+/* k-th command of current transaction:                        */
+/* start, [write dev, write.., restart], [write dev, read..],    */
+/* stop/restart                                                  */
+uint32_t I2cCore::cmd_at(int k) {
+   uint32_t dev = cur->dev << 1;
 
-   dev_byte = (dev << 1) | 0x01;   // LSB=1 for I2c read
-   start();
-   ack1 = write_byte(dev_byte);    // send device id/read
-   for (i = 0; i < (num - 1); i++) {
-      *bytes = read_byte(0);
-      bytes++;
+   if (k == 0)
+      return (I2C_START_CMD);
+   k--;
+   if (cur->wnum > 0 || cur->rnum == 0) {
+      if (k == 0)
+         return (I2C_WR_CMD | I2C_LOG_FLAG | dev);  // LSB=0 for write
+      k--;
+      if (k < cur->wnum)
+         return (I2C_WR_CMD | I2C_LOG_FLAG | cur->wbytes[k]);
+      k = k - cur->wnum;
+      if (cur->rnum > 0) {
+         if (k == 0)
+            return (I2C_RESTART_CMD);  // repeated start; bus is not released
+         k--;
+      }
+   }
+   if (cur->rnum > 0) {
+      if (k == 0)
+         return (I2C_WR_CMD | I2C_LOG_FLAG | dev | 0x01); // LSB=1 for read
+      k--;
+      if (k < cur->rnum)
+         return (I2C_RD_CMD | I2C_LOG_FLAG | (k == cur->rnum - 1)); // NACK last byte
    }
-   *bytes = read_byte(1);   // last byte in read cycle
-   if (rstart == 1) {
-      restart();
-   } else {
-      stop();
+   return ((cur->rstart == 1) ? I2C_RESTART_CMD : I2C_STOP_CMD);
+}
+
+int I2cCore::submit(i2c_xfer_t *xfer) {
+   if (cur)
+      return (-1);
+   cur = xfer;
+   step = 0;
+   credit = FIFO_DEPTH;
+   n_logged = 0;
+   n_collected = 0;
+   nack_cnt = 0;
+   rd_ptr = xfer->rbytes;
+   n_acks = (xfer->rnum > 0) ? 1 : 0;   // device id/read
+   n_steps = 2;                         // start, stop/restart
+   if (xfer->wnum > 0 || xfer->rnum == 0) {
+      n_acks = n_acks + 1 + xfer->wnum; // device id/write plus data
+      n_steps = n_steps + 1 + xfer->wnum + (xfer->rnum > 0);
    }
-   return (ack1);
+   if (xfer->rnum > 0)
+      n_steps = n_steps + 1 + xfer->rnum;
+   xfer->status = I2C_XFER_PENDING;
+   return (0);
+}
+
+/* FIFO status is only checked after FIFO_DEPTH blind pushes;       */
+/* a logged command is held back while the read-data FIFO is full   */
+int I2cCore::poll() {
+   uint32_t cmd, rd_word;
+   i2c_xfer_t *xfer;
+
+   if (!cur)
+      return (0);
+   // collect the results already available
+   while (n_collected < n_logged) {
+      rd_word = io_read(base_addr, RX_FIFO_REG);
+      if (rd_word & RX_EMPT_FIELD)
+         break;
+      io_write(base_addr, RX_FIFO_REG, 0); //dummy write to remove data from FIFO
+      if (n_collected < n_acks) {
+         if (rd_word & RX_ACK_FIELD)
+            nack_cnt++;     // slave fails to ack
+      } else {
+         *rd_ptr = (uint8_t) (rd_word & 0xff);
+         rd_ptr++;
+      }
+      n_collected++;
+   }
+   // push the commands the FIFO can take
+   while (step < n_steps) {
+      cmd = cmd_at(step);
+      if ((cmd & I2C_LOG_FLAG) && (n_logged - n_collected) == FIFO_DEPTH)
+         break;
+      if (credit == 0) {
+         if (io_read(base_addr, RD_REG) & CMD_FULL_FIELD)
+            break;
+         credit = 1;
+      }
+      io_write(base_addr, WR_REG, cmd);
+      credit--;
+      step++;
+      if (cmd & I2C_LOG_FLAG)
+         n_logged++;
+   }
+   // done when all results are in and the bus is idle
+   if (step < n_steps || n_collected < n_logged || !ready())
+      return (1);
+   xfer = cur;
+   cur = 0;
+   xfer->status = -nack_cnt;
+   if (xfer->done)
+      xfer->done(xfer);
+   return (0);
+}
+
+int I2cCore::busy() {
+   return (cur != 0);
+}
+
+/* blocking transaction: submit and poll until done */
+int I2cCore::transfer(uint8_t dev, uint8_t *wbytes, int wnum,
+      uint8_t *rbytes, int rnum, int rstart) {
+   i2c_xfer_t xfer;
+
+   xfer.dev = dev;
+   xfer.wbytes = wbytes;
+   xfer.wnum = wnum;
+   xfer.rbytes = rbytes;
+   xfer.rnum = rnum;
+   xfer.rstart = rstart;
+   xfer.done = 0;
+   xfer.arg = 0;
+   while (submit(&xfer) != 0)
+      poll();        // finish a submitted transaction first
+   while (poll()) {
+   }
+   return (xfer.status);
+}
+int I2cCore::read_transaction(uint8_t dev, uint8_t *bytes, int num,
+      int rstart) {
+   return (transfer(dev, 0, 0, bytes, num, rstart));
 }
 
 int I2cCore::write_transaction(uint8_t dev, uint8_t *bytes, int num,
       int rstart) {
-   uint8_t dev_byte;
-   int ack1, ack;
+   return (transfer(dev, bytes, num, 0, 0, rstart));
+}
+
+int I2cCore::read_block(uint8_t dev, uint8_t reg, uint8_t *bytes, int num) {
+   return (transfer(dev, &reg, 1, bytes, num, 0));
+}
+
+int I2cCore::write_block(uint8_t dev, uint8_t reg, uint8_t *bytes, int num) {
+   uint8_t wbytes[BLOCK_MAX + 1];
    int i;
 
-   dev_byte = (dev << 1);   // LSB=0 for I2c write
-   start();
-   ack = write_byte(dev_byte);  // send device id/write
-   for (i = 0; i < num; i++) {
-      ack1 = write_byte(*bytes);
-      ack = ack + ack1;
-      bytes++;
-   }
-   if (rstart == 1) {
-      restart();
-   } else {
-      stop();
-   }
-   return (ack);
+   if (num > BLOCK_MAX)
+      return (-1);
+   wbytes[0] = reg;
+   for (i = 0; i < num; i++)
+      wbytes[i + 1] = bytes[i];
+   return (transfer(dev, wbytes, num + 1, 0, 0, 0));
+}
+
+int I2cCore::write_read_transaction(uint8_t dev, uint8_t *wbytes, int wnum,
+      uint8_t *rbytes, int rnum) {
+   return (transfer(dev, wbytes, wnum, rbytes, rnum, 0));
 }
@@ -7,6 +7,12 @@
  * - 5 basic commands: start, read, write, stop, restart
  * - i2c transaction can be "assembled" with commands
  *   e.g., start, write, write, stop
+ * - transactions are pushed into the core's command FIFO as a whole
+ *   and the results are collected from the read-data FIFO
+ * - a transaction can also be submitted as a descriptor and advanced
+ *   by poll() without blocking (submit()/poll())
+ * - standard (100K), fast (400K) and fast-plus (1M) mode; the core
+ *   supports slave clock stretching
  *
  * @author p chu
  * @version v1.0: initial release
@@ -17,6 +23,24 @@
 
 #include "chu_init.h"
 
+/**
+ * descriptor of a non-blocking i2c transaction
+ *
+ * command sequence: start, [write dev, write, .. write, restart],
+ * [write dev, read, .. read], stop/restart
+ */
+typedef struct i2c_xfer {
+   uint8_t dev;         /**< device id */
+   uint8_t *wbytes;     /**< write data array */
+   int wnum;            /**< # bytes to be written */
+   uint8_t *rbytes;     /**< read data array */
+   int rnum;            /**< # bytes to be read */
+   int rstart;          /**< 1: end with "restart"; 0: end with "stop" */
+   volatile int status; /**< I2C_XFER_PENDING or ack status when done */
+   void (*done)(struct i2c_xfer *xfer);  /**< completion callback or 0 */
+   void *arg;           /**< user data for the callback */
+} i2c_xfer_t;
+
 /**
  * i2c core driver
  * - access MMIO i2c core
@@ -34,16 +58,53 @@ public:
     * bits 7-0: data
     * bit 8: ready
     * bit 9: acknowledge
+    * bit 10: command FIFO full
+    * bit 11: read-data FIFO empty
     *
     * write data reg in write operation:
     * bits 7-0: data
     * bits 10-8: command
-
+    * bit 11: log result into read-data FIFO
+    *
+    * read-data FIFO reg:
+    * bits 7-0: data
+    * bit 8: acknowledge
+    * bit 9: read-data FIFO empty
+    * (dummy write removes the head of the FIFO)
     */
    enum {
 	  RD_REG = 0,    /**< read data/status register */
       DVSR_REG = 1,
-      WR_REG = 2   /**< write data/command register */
+      WR_REG = 2,    /**< write data/command register */
+      RX_FIFO_REG = 3 /**< read-data FIFO head/remove register */
+   };
+   /**
+    * field masks
+    *
+    */
+   enum {
+      CMD_FULL_FIELD = 0x00000400, /**< bit 10 of rd_reg; command FIFO full */
+      RX_EMPT_FIELD = 0x00000200,  /**< bit 9 of rx_fifo_reg; empty bit */
+      RX_ACK_FIELD = 0x00000100,   /**< bit 8 of rx_fifo_reg; ack bit */
+      FIFO_DEPTH = 32              /**< # entries of command/read-data FIFOs */
+   };
+   /**
+    * status of a submitted transaction
+    *
+    */
+   enum {
+      I2C_XFER_PENDING = 1         /**< transaction not completed yet */
+   };
+   /**
+    * minimum scl low time (ns) of each bus mode
+    *
+    */
+   enum {
+      SM_TLOW_NS = 4700,           /**< standard mode, up to 100K Hz */
+      FM_TLOW_NS = 1300,           /**< fast mode, up to 400K Hz */
+      FMP_TLOW_NS = 500,           /**< fast mode plus, up to 1M Hz */
+      PROBE_LEN = 8,               /**< # bytes per probe_freq() trial */
+      BLOCK_MAX = 32               /**< max # data bytes of write_block() */
    };
    /**
     * symbolic commands
@@ -54,7 +115,8 @@ public:
       I2C_WR_CMD = 0x01 << 8,     /**< write command */
       I2C_RD_CMD = 0x02 << 8,     /**< read command */
       I2C_STOP_CMD = 0x03 << 8,   /**< stop command */
-      I2C_RESTART_CMD = 0x04 << 8 /**< restart command */
+      I2C_RESTART_CMD = 0x04 << 8, /**< restart command */
+      I2C_LOG_FLAG = 0x01 << 11    /**< log result into read-data FIFO */
    };
    /* methods */
    /**
@@ -70,9 +132,35 @@ public:
     *
     * @param freq i2c clock frequency
     *
+    * @note the divisor is rounded up and limited by the minimum scl
+    *       low time of the bus mode; sclk never exceeds freq
+    *       (e.g., 400K Hz request gives 384.6K Hz at 100 MHz)
+    *
     */
    void set_freq(int freq);
 
+   /**
+    * actual i2c clock (sclk) frequency set by set_freq()
+    *
+    */
+   int get_freq();
+
+   /**
+    * find the highest reliable i2c clock frequency of a device
+    *
+    * @param dev device id
+    * @param reg first register of a block with constant contents
+    * @param trials # block reads that must match at each frequency
+    * @return selected frequency; -1 if device fails at 100K Hz
+    *
+    * @note a PROBE_LEN-byte block is read at 100K Hz as reference, then
+    *       1M/400K Hz are tried from the top; the first frequency whose
+    *       reads are all acked and match is kept
+    * @note all devices on the bus must support the selected frequency
+    *
+    */
+   int probe_freq(uint8_t dev, uint8_t reg, int trials);
+
    /**
     * indicate whether i2c core is ready to take a command
     *
@@ -130,6 +218,8 @@ public:
     * @return retrieved data store in bytes array
     *
     * @note command sequence: start, write dev, read, .. read, stop/restart
+    * @note commands are pushed into the command FIFO back-to-back;
+    *       the core does not wait on software between bytes
     *
     */
    int read_transaction(uint8_t dev, uint8_t *bytes, int num,
@@ -151,9 +241,110 @@ public:
    int write_transaction(uint8_t dev, uint8_t *bytes, int num,
          int restart);
 
+   /**
+    * perform a combined write-then-read transaction
+    *
+    * @param dev device id
+    * @param wbytes pointer to write data array (e.g., register address)
+    * @param wnum number of bytes to be written
+    * @param rbytes pointer to read data array
+    * @param rnum number of bytes to be read
+    *
+    * @return device ack status (0: ok; negative: # failed acks)
+    * @return retrieved data store in rbytes array
+    *
+    * @note command sequence: start, write dev, write, .. write,
+    *       restart, write dev, read, .. read, stop
+    * @note a device with register auto-increment returns a whole
+    *       register block in one bus transaction
+    *
+    */
+   int write_read_transaction(uint8_t dev, uint8_t *wbytes, int wnum,
+         uint8_t *rbytes, int rnum);
+
+   /**
+    * read a register block (sequential/auto-increment read)
+    *
+    * @param dev device id
+    * @param reg address of first register (word address for EEPROM)
+    * @param bytes pointer to read data array
+    * @param num number of bytes to be read
+    *
+    * @return device ack status (0: ok; negative: # failed acks)
+    *
+    * @note one transaction: start, write dev, write reg,
+    *       restart, write dev, read, .. read, stop
+    *
+    */
+   int read_block(uint8_t dev, uint8_t reg, uint8_t *bytes, int num);
+
+   /**
+    * write a register block (auto-increment write)
+    *
+    * @param dev device id
+    * @param reg address of first register
+    * @param bytes pointer to write data array
+    * @param num number of bytes to be written (up to BLOCK_MAX)
+    *
+    * @return device ack status (0: ok; negative: # failed acks)
+    *
+    * @note one transaction: start, write dev, write reg,
+    *       write, .. write, stop
+    * @note an EEPROM write must not cross its page boundary
+    *
+    */
+   int write_block(uint8_t dev, uint8_t reg, uint8_t *bytes, int num);
+
+   /**
+    * submit a non-blocking transaction
+    *
+    * @param xfer pointer to transaction descriptor
+    * @return 0: accepted; -1: a transaction is still in progress
+    *
+    * @note xfer->status is I2C_XFER_PENDING until the transaction completes;
+    *       it then holds the ack status (0: ok; negative: # failed acks)
+    *       and xfer->done (if not 0) is called from poll()
+    * @note descriptor and data arrays must stay valid until completion
+    *
+    */
+   int submit(i2c_xfer_t *xfer);
+
+   /**
+    * advance the submitted transaction without waiting
+    *
+    * @return 1: transaction in progress; 0: idle
+    *
+    * @note each call pushes the commands the command FIFO can take,
+    *       collects the results already available and completes the
+    *       transaction when the bus is done
+    * @note the blocking methods must not be used while busy
+    *
+    */
+   int poll();
+
+   /**
+    * indicate whether a submitted transaction is in progress
+    *
+    */
+   int busy();
+
 private:
    /* variable to keep track of current status */
    uint32_t base_addr;
+   uint32_t dvsr;       // current divisor (quarter scl period)
+   i2c_xfer_t *cur;     // transaction in progress (0: idle)
+   int step;            // index of next command of current transaction
+   int n_steps;         // # commands of current transaction
+   int credit;          // # pushes allowed before FIFO status is checked
+   int n_logged;        // # results logged in current transaction
+   int n_collected;     // # results collected in current transaction
+   int n_acks;          // # leading results that are write acks
+   int nack_cnt;        // # failed acks in current transaction
+   uint8_t *rd_ptr;     // destination of read data
+   /* methods */
+   uint32_t cmd_at(int k);
+   int transfer(uint8_t dev, uint8_t *wbytes, int wnum,
+         uint8_t *rbytes, int rnum, int rstart);
 
 };
 
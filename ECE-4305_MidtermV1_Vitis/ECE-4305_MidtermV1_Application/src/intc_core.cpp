@@ -0,0 +1,52 @@
+/*****************************************************************//**
+ * @file intc_core.cpp
+ *
+ * @brief implementation of IntcCore class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "intc_core.h"
+#include "sys_clock.h"
+
+IntcCore::IntcCore(uint32_t core_base_addr) {
+   base_addr = core_base_addr;
+   en_mask = 0;
+   io_write(base_addr, ENABLE_REG, en_mask);
+   io_write(base_addr, ACK_REG, 0xffffffff);
+}
+
+IntcCore::~IntcCore() {
+}
+
+void IntcCore::enable(int src) {
+   ack(src);
+   en_mask = en_mask | (1 << src);
+   io_write(base_addr, ENABLE_REG, en_mask);
+}
+
+void IntcCore::disable(int src) {
+   en_mask = en_mask & ~(1 << src);
+   io_write(base_addr, ENABLE_REG, en_mask);
+}
+
+int IntcCore::pending(int src) {
+   return ((int) (io_read(base_addr, PENDING_REG) >> src) & 0x01);
+}
+
+void IntcCore::ack(int src) {
+   io_write(base_addr, ACK_REG, (uint32_t) 1 << src);
+}
+
+int IntcCore::wait(int src, unsigned long timeout_us) {
+   sys_clock::time_point deadline;
+
+   // deadline in clock cycles; no divide in the polling loop
+   deadline = sys_clock::now() + std::chrono::microseconds(timeout_us);
+   while (!pending(src)) {
+      if (sys_clock::now() > deadline)
+         return (-1);
+   }
+   ack(src);
+   return (0);
+}
@@ -0,0 +1,102 @@
+/*****************************************************************//**
+ * @file intc_core.h
+ *
+ * @brief access interrupt controller of MicroBlaze MCS IO module
+ *
+ * Description:
+ * - external interrupt lines (INTC_Interrupt) are latched by the
+ *   controller (edge or level, set in the MCS configuration)
+ * - the driver uses the latched status; cpu interrupts
+ *   (MSR IE) are not enabled and no handler is installed
+ * - a pending source is waited on and acknowledged by software
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _INTC_CORE_H_INCLUDED
+#define _INTC_CORE_H_INCLUDED
+
+#include "chu_init.h"
+
+/**
+ * MCS interrupt controller driver
+ * - enable/acknowledge interrupt sources
+ * - wait for the (latched) edge of a source
+ *
+ */
+class IntcCore {
+public:
+   /**
+    * register map (word offset from IO module base)
+    *
+    */
+   enum {
+      STATUS_REG = 0x30/4,  /**< IRQ_STATUS (read) */
+      PENDING_REG = 0x34/4, /**< IRQ_PENDING = status & enable (read) */
+      ENABLE_REG = 0x38/4,  /**< IRQ_ENABLE (write only) */
+      ACK_REG = 0x3C/4      /**< IRQ_ACK; 1 clears status bit (write) */
+   };
+   /**
+    * interrupt source bit positions
+    *
+    */
+   enum {
+      EXT_INTR_BASE = 16    /**< INTC_Interrupt[0] maps to bit 16 */
+   };
+   /* methods */
+   /**
+    * constructor
+    *
+    * @note all sources disabled and acknowledged
+    */
+   IntcCore(uint32_t core_base_addr);
+   ~IntcCore();                  // not used
+
+   /**
+    * enable an interrupt source (stale event acknowledged first)
+    *
+    * @param src source bit position (e.g., EXT_INTR_BASE+0)
+    *
+    */
+   void enable(int src);
+
+   /**
+    * disable an interrupt source
+    *
+    * @param src source bit position
+    *
+    */
+   void disable(int src);
+
+   /**
+    * check whether an enabled source has a latched event
+    *
+    * @param src source bit position
+    *
+    */
+   int pending(int src);
+
+   /**
+    * clear the latched event of a source
+    *
+    * @param src source bit position
+    *
+    */
+   void ack(int src);
+
+   /**
+    * wait for the event of a source and acknowledge it
+    *
+    * @param src source bit position
+    * @param timeout_us max wait time in microsecond
+    * @return 0: event received; -1: timeout
+    *
+    */
+   int wait(int src, unsigned long timeout_us);
+
+private:
+   uint32_t base_addr;
+   uint32_t en_mask;    // shadow of write-only enable register
+};
+
+#endif  // _INTC_CORE_H_INCLUDED
@@ -0,0 +1,145 @@
+/*****************************************************************//**
+ * @file isl29501.cpp
+ *
+ * @brief implementation of Isl29501 class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "isl29501.h"
+
+Isl29501::Isl29501(I2cCore *i2c_p, uint8_t dev) {
+   i2c = i2c_p;
+   this->dev = dev;
+   n_bursts = 0;
+   invalidate();
+}
+
+Isl29501::~Isl29501() {
+}
+
+void Isl29501::invalidate() {
+   int i;
+
+   for (i = 0; i < 8; i++)
+      valid[i] = 0;
+}
+
+int Isl29501::cached(uint8_t reg) {
+   return ((int) (valid[reg >> 5] >> (reg & 0x1f)) & 0x01);
+}
+
+int Isl29501::write_reg(uint8_t reg, uint8_t data) {
+   uint8_t wbytes[2];
+   int status;
+
+   if (cached(reg) && shadow[reg] == data)
+      return (0);
+   wbytes[0] = reg;
+   wbytes[1] = data;
+   status = i2c->write_transaction(dev, wbytes, 2, 0);
+   if (status != 0) {
+      valid[reg >> 5] &= ~((uint32_t) 1 << (reg & 0x1f));
+      return (status);
+   }
+   shadow[reg] = data;
+   valid[reg >> 5] |= (uint32_t) 1 << (reg & 0x1f);
+   return (1);
+}
+
+int Isl29501::write_block(uint8_t reg, uint8_t *data, int num) {
+   int i, same = 1, status;
+
+   if (num <= 0 || num > I2cCore::BLOCK_MAX || reg + num > 256)
+      return (-1);
+   for (i = 0; i < num; i++)
+      if (!cached(reg + i) || shadow[reg + i] != data[i])
+         same = 0;
+   if (same)
+      return (0);
+   status = i2c->write_block(dev, reg, data, num);
+   for (i = 0; i < num; i++) {
+      if (status == 0) {
+         shadow[reg + i] = data[i];
+         valid[(reg + i) >> 5] |= (uint32_t) 1 << ((reg + i) & 0x1f);
+      } else
+         valid[(reg + i) >> 5] &= ~((uint32_t) 1 << ((reg + i) & 0x1f));
+   }
+   return ((status == 0) ? 1 : status);
+}
+
+int Isl29501::write_regs(const uint8_t (*table)[2], int num) {
+   int i, status, n = 0, err = 0;
+
+   for (i = 0; i < num; i++) {
+      status = write_reg(table[i][0], table[i][1]);
+      if (status < 0)
+         err++;
+      else
+         n = n + status;
+   }
+   return ((err) ? -err : n);
+}
+
+void Isl29501::expect(uint8_t reg, uint8_t data) {
+   shadow[reg] = data;
+   valid[reg >> 5] |= (uint32_t) 1 << (reg & 0x1f);
+}
+
+int Isl29501::read_reg(uint8_t reg, uint8_t *data) {
+   return (i2c->write_read_transaction(dev, &reg, 1, data, 1));
+}
+
+int Isl29501::command(uint8_t cmd) {
+   uint8_t wbytes[2];
+
+   if (cmd == SOFT_RESET_CMD)
+      invalidate();
+   wbytes[0] = CMD_REG;
+   wbytes[1] = cmd;
+   return (i2c->write_transaction(dev, wbytes, 2, 0));
+}
+
+/* cached registers are read in bursts; a burst spans up to VERIFY_GAP */
+/* uncached registers so that nearby blocks share one transaction      */
+int Isl29501::verify() {
+   uint8_t bytes[VERIFY_MAX];
+   uint8_t first;
+   int reg, last, gap, i, mism = 0;
+
+   n_bursts = 0;
+   reg = 0;
+   while (reg < 256) {
+      if (!cached(reg)) {
+         reg++;
+         continue;
+      }
+      // extend burst while the next cached register is close enough
+      first = (uint8_t) reg;
+      last = reg;
+      gap = 0;
+      for (reg = reg + 1; reg < 256 && (reg - first) < VERIFY_MAX; reg++) {
+         if (cached(reg)) {
+            last = reg;
+            gap = 0;
+         } else if (++gap > VERIFY_GAP)
+            break;
+      }
+      reg = last + 1;
+      if (i2c->write_read_transaction(dev, &first, 1, bytes,
+            last - first + 1) != 0)
+         return (-1);
+      n_bursts++;
+      for (i = first; i <= last; i++) {
+         if (cached(i) && bytes[i - first] != shadow[i]) {
+            valid[i >> 5] &= ~((uint32_t) 1 << (i & 0x1f));
+            mism++;
+         }
+      }
+   }
+   return (mism);
+}
+
+int Isl29501::verify_bursts() {
+   return (n_bursts);
+}
@@ -0,0 +1,166 @@
+/*****************************************************************//**
+ * @file isl29501.h
+ *
+ * @brief ISL29501 ToF DSP register access over an i2c core
+ *
+ * Description:
+ * - keep a shadow copy of the DSP register map
+ * - writes of values equal to the shadow copy are skipped;
+ *   reconfiguration only costs the registers that change
+ * - written registers are verified with one burst readback per
+ *   contiguous register block
+ * - expected values can be loaded into the shadow copy without a
+ *   write; verify() then tells whether the device already holds them
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _ISL29501_H_INCLUDED
+#define _ISL29501_H_INCLUDED
+
+#include "i2c_core.h"
+
+/**
+ * ISL29501 DSP driver
+ * - cached register writes and batched verification
+ *
+ */
+class Isl29501 {
+public:
+   /**
+    * register map (subset)
+    *
+    */
+   enum {
+      DEV_ID_REG = 0x00,       /**< device id */
+      SAMPLE_PERIOD_REG = 0x11,/**< sample period */
+      SAMPLE_CTRL_REG = 0x13,  /**< sample control; bit 0: single shot */
+      INT_CTRL_REG = 0x60,     /**< interrupt control */
+      IRQ_STAT_REG = 0x69,     /**< interrupt status; read releases irq */
+      CMD_REG = 0xB0,          /**< command register (not cached) */
+      RESULT_REG = 0xD1        /**< distance msb; lsb and precision follow */
+   };
+   /**
+    * command codes (written to CMD_REG)
+    *
+    */
+   enum {
+      SAMPLE_START_CMD = 0x49, /**< start a sample */
+      SOFT_RESET_CMD = 0xD7    /**< reset registers to factory values */
+   };
+   /**
+    * verify parameters
+    *
+    */
+   enum {
+      VERIFY_GAP = 4,          /**< max # unwritten registers inside a burst */
+      VERIFY_MAX = 32          /**< max # bytes per verify burst */
+   };
+   /* methods */
+   /**
+    * constructor
+    *
+    * @param i2c_p pointer to i2c core the DSP is attached to
+    * @param dev 7-bit device address
+    *
+    * @note shadow copy starts empty (first write of every register goes out)
+    */
+   Isl29501(I2cCore *i2c_p, uint8_t dev);
+   ~Isl29501();                  // not used
+
+   /**
+    * write a register unless the cached value is the same
+    *
+    * @param reg register address
+    * @param data register value
+    * @return 1: written; 0: skipped; negative: device ack failed
+    *
+    */
+   int write_reg(uint8_t reg, uint8_t data);
+
+   /**
+    * write consecutive registers in one auto-increment transaction
+    *
+    * @param reg address of first register
+    * @param data pointer to register values
+    * @param num number of registers (up to I2cCore::BLOCK_MAX)
+    * @return 1: written; 0: skipped (all cached); negative: ack failed
+    *         or num out of range (cache untouched)
+    *
+    */
+   int write_block(uint8_t reg, uint8_t *data, int num);
+
+   /**
+    * write a table of {register, value} pairs
+    *
+    * @param table pointer to pairs
+    * @param num number of pairs
+    * @return # registers written; negative: # failed transactions
+    *
+    */
+   int write_regs(const uint8_t (*table)[2], int num);
+
+   /**
+    * load an expected register value into the shadow copy (no write)
+    *
+    * @param reg register address
+    * @param data expected register value
+    *
+    * @note used with verify() to check a configuration kept by the
+    *       device (e.g., across a cpu-only reset)
+    *
+    */
+   void expect(uint8_t reg, uint8_t data);
+
+   /**
+    * read a register from the device (bypasses the cache)
+    *
+    * @param reg register address
+    * @param data pointer to register value
+    * @return device ack status (0: ok; negative: # failed acks)
+    *
+    */
+   int read_reg(uint8_t reg, uint8_t *data);
+
+   /**
+    * issue a command (CMD_REG write; never cached)
+    *
+    * @param cmd command code (e.g., SAMPLE_START_CMD)
+    * @note SOFT_RESET_CMD also clears the shadow copy
+    *
+    */
+   int command(uint8_t cmd);
+
+   /**
+    * read back all cached registers and compare with the shadow copy
+    *
+    * @return # mismatched registers; negative: device ack failed
+    *
+    * @note mismatched registers are dropped from the cache so the
+    *       next write_reg() goes out to the device
+    *
+    */
+   int verify();
+
+   /**
+    * # bus transactions used by the last verify()
+    *
+    */
+   int verify_bursts();
+
+   /**
+    * discard the shadow copy
+    *
+    */
+   void invalidate();
+
+private:
+   I2cCore *i2c;
+   uint8_t dev;
+   uint8_t shadow[256];    // cached register values
+   uint32_t valid[8];      // 1 bit per register: shadow value valid
+   int n_bursts;           // # bursts in last verify
+   int cached(uint8_t reg);
+};
+
+#endif  // _ISL29501_H_INCLUDED
@@ -34,12 +34,77 @@
 #include "ps2_core.h"
 #include "ddfs_core.h"
 #include "adsr_core.h"
+#include "tof_acq_core.h"
+#include "intc_core.h"
+#include "isl29501.h"
+#include "tof_array.h"
+#include "telemetry.h"
+#include "prof.h"
+#include "periodic_sched.h"
+#include "sys_clock.h"
 #include <cstdint>
 
 // Addresses to i2c devices...
 #define dev_PMOD_RENESAS_DSP 0x57   // Renesas DSP onboard the ToF Sensor
 #define dev_PMOD_EEPROM 0x50        // ATMEL EEPROM onboard the ToF Sensor
 
+// ISL29501 result block: 0xD1/0xD2 distance, 0xD3/0xD4 precision...
+#define ISL29501_RESULT_REG 0xD1
+#define ISL29501_RESULT_LEN 4
+#define ISL29501_IRQ_STAT_REG 0x69  // reading releases the IRQ line
+
+// ToF IRQ (data ready, jb_top[1]) on MCS external interrupt 0...
+#define TOF_IRQ_SRC (IntcCore::EXT_INTR_BASE + 0)
+#define TOF_IRQ_TIMEOUT_US 100000
+
+// 1: DSP free-running (continuous) conversion, firmware only drains results;
+// 0: single-shot, firmware issues a sample start per reading...
+#define TOF_CONTINUOUS 0
+#define ISL29501_SAMPLE_CTRL_CONT 0x70  // 0x71 with bit 0 (single shot) cleared
+#define ISL29501_SAMPLE_PERIOD 0x6E     // same period as the digilent setup
+#define RATE_WINDOW_MS 1000             // samples/s report interval
+
+// 1: time the distance pipeline (soft-float vs fixed-point) at startup...
+#define TOF_BENCH 0
+#define TOF_BENCH_N 1000
+
+// Sample period of the single-shot loop (fixed-rate scheduler); samples
+// start on a grid of the period so they are evenly spaced. 0: back-to-back
+// samples as fast as the bus and uart allow...
+#define TOF_SCHED_PERIOD_US 100000
+#define TOF_SCHED_POLICY PeriodicSched::SKIP   // or CATCH_UP on overruns
+
+// 1: samples taken by the hardware acquisition engine (slot 14);
+// 0: cpu issues each sample over i2c...
+#define TOF_ACQ_HW 0
+#define TOF_ACQ_PERIOD_US 10000     // sample period of acquisition engine
+#define TOF_ACQ_CONV_US 5000        // sample start to result read
+#define TOF_ACQ_BURST 8             // # samples drained per pass
+
+// 1: second sensor on the slot 10 i2c bus, both read by the interleaved
+// sensor-array scheduler (per-sensor streams); 0: single sensor...
+#define TOF_MULTI 0
+#define TOF_MULTI_PERIOD_US 10000   // per-sensor sample period
+#define TOF_MULTI_CONV_US 5000      // sample start to result read
+
+// 1: samples sent as binary frames (telemetry.h) at startup; 0: text...
+// At runtime 'b'/'t' received on the uart switch to binary/text output.
+#define TOF_TELEMETRY 0
+
+// Profiled phases of a sample (PROF_ENABLE in prof.h); 'p' received on
+// the uart prints the profile, 'r' clears it. Phases nest: "sample" covers
+// one whole loop pass, "uart" includes the "convert" it calls...
+enum {
+    PH_SAMPLE,     // one pass of the sampling loop
+    PH_START,      // sample-start write
+    PH_WAIT,       // data-ready wait (conversion)
+    PH_RESULT,     // irq release and result block read
+    PH_CONVERT,    // raw to micrometers
+    PH_UART,       // formatting and queueing of the sample
+    PH_SSEG,       // seven-segment update
+    PH_DRAIN       // result read completion while the uart drains (continuous)
+};
+
 // Terminal color escape sequences...
 #define RESET "\033[0m"
 #define GREEN "\033[1;32m"
@@ -64,139 +129,347 @@ int easy_read_transaction(I2cCore *i2c, uint8_t dev_addr, uint8_t reg_addr, uint
     return i2c->read_transaction(dev_addr, bytes, num, 0);
 }
 
+// Digilent recommended DSP configs...
+static const uint8_t digilent_values[][2] = {
+    {0x10, 0x04}, // Integration Period Register
+    {0x11, 0x6E}, // Sample Period Register
+    {0x13, 0x71}, // Sample Control Register
+    {0x18, 0x22}, // Optimize AGC
+    {0x19, 0x22}, // Automatic Gain Control
+    {0x60, 0x01}, // Interrupt Control
+    {0x90, 0x0F}, // Driver Range
+    {0x91, 0xFF}, // Emitter DAC
+};
+#define NUM_DIGILENT_VALUES (int)(sizeof(digilent_values) / sizeof(digilent_values[0]))
+
+// Calibration block: EEPROM 0x21.. copied to DSP 0x24..0x30
+#define CAL_EEPROM_START (0x20 + 1) //Magic number at 0x20 (only used for alignment shift up by 1), see datasheet...
+#define CAL_DSP_START 0x24
+#define CAL_LEN 13
+
 /**
  * Writes recommended initialization values to the ISL29501 DSP registers.
  *
- * @param ISL29501_p Pointer to the I2C core instance for the ISL29501 device.
- * @param dev_addr I2C device address of the ISL29501 DSP.
+ * Registers already holding the value (per the driver's shadow copy)
+ * are skipped; the values are verified later in one pass.
+ *
+ * @param dsp Pointer to the ISL29501 driver instance.
  */
-void write_digilent_values(I2cCore *ISL29501_p, uint8_t dev_addr) {
-    uint8_t wbytes[2], bytes[1];
-
-   
-    uart.disp("--------------[INITIALIZATION]--------------\r\n");
-    uint8_t init_mappings[][2] = {
-        {0x10, 0x04}, // Integration Period Register
-        {0x11, 0x6E}, // Sample Period Register
-        {0x13, 0x71}, // Sample Control Register
-        {0x18, 0x22}, // Optimize AGC
-        {0x19, 0x22}, // Automatic Gain Control
-        {0x60, 0x01}, // Interrupt Control
-        {0x90, 0x0F}, // Driver Range
-        {0x91, 0xFF}, // Emitter DAC
-    };
-
-    int num_entries = sizeof(init_mappings) / sizeof(init_mappings[0]);
-    for (int i = 0; i < num_entries; ++i) {
-        wbytes[0] = init_mappings[i][0];
-        wbytes[1] = init_mappings[i][1];
-        ISL29501_p->write_transaction(dev_addr, wbytes, 2, 0);
-
-        easy_read_transaction(ISL29501_p, dev_addr, wbytes[0], bytes, 1);
-        uart.disp("Value @ 0x");
-        uart.disp(wbytes[0], 16);
-        uart.disp(" : 0x");
-        uart.disp(bytes[0], 16);
-        uart.disp("\n\r");
-    }
-    uart.disp("----------------[END INITIALIZATION]----------------\n\r");
+void write_digilent_values(Isl29501 *dsp) {
+    dsp->write_regs(digilent_values, NUM_DIGILENT_VALUES);
 }
 
 
 /**
- * Reads calibration data from EEPROM and writes it to the DSP.
+ * Reads calibration data from EEPROM.
+ *
+ * The EEPROM block is fetched with one sequential read.
  *
  * @param ISL29501_p Pointer to the I2C core instance.
  * @param eeprom_addr I2C device address of the EEPROM.
- * @param dsp_addr I2C device address of the DSP.
+ * @param values Buffer for the CAL_LEN calibration bytes.
+ * @return EEPROM ack status (0: ok; negative: # failed acks).
  */
-void read_eeprom_calibration(I2cCore *ISL29501_p, uint8_t eeprom_addr, uint8_t dsp_addr) {
-    uint8_t read_start_address = 0x20 + 1; //Magic number at 0x20 (only used for alignment shift up by 1), see datasheet...
-    uint8_t write_start_address = 0x24;
-    uint8_t num_addresses = 13;
-    uint8_t values[13];
-    uint8_t wbytes[2], bytes[1];
-
-    uart.disp("\r\n-----[COPYING CALIBRATION FROM EEPROM]-----\r\n");
-    //Read from EEPROM starting at address 0x21 to (0x21 + 13 - 1)
-    for (uint8_t i = 0; i < num_addresses; ++i) {
-        easy_read_transaction(ISL29501_p, eeprom_addr, read_start_address + i, bytes, 1);
-        values[i] = bytes[0];
-    }
-    
-    //Write values read from EEPROM to DSP starting at address 0x24 to 0x30. (13 values...)
-    for (uint8_t i = 0; i < num_addresses; ++i) {
-        wbytes[0] = write_start_address + i;
-        wbytes[1] = values[i];
-        ISL29501_p->write_transaction(dsp_addr, wbytes, 2, 0);
-    }
+int read_eeprom_calibration(I2cCore *ISL29501_p, uint8_t eeprom_addr, uint8_t *values) {
+    //Read from EEPROM starting at address 0x21 to (0x21 + 13 - 1) in one sequential read
+    return ISL29501_p->read_block(eeprom_addr, CAL_EEPROM_START, values, CAL_LEN);
 }
 
 /**
- * Initializes the ISL29501 DSP by performing a factory reset,
- * loading EEPROM calibration data, and applying recommended values.
+ * Initializes the ISL29501 DSP.
+ *
+ * Warm path: the expected calibration and configuration (EEPROM block
+ * plus recommended values) are loaded into the driver's shadow copy and
+ * read back from the DSP in bursts. When the DSP still holds them
+ * (e.g., after a CPU-only reset) the factory reset and copy are skipped.
+ * Cold path: factory reset, calibration copy (one auto-increment write)
+ * and recommended values, followed by the same burst verify.
+ * EEPROM read failure: no valid calibration to compare or copy; the
+ * error is reported and the cold path runs without the calibration
+ * write (verify then covers the recommended values only).
  *
  * @param ISL29501_p Pointer to the I2C core instance.
- * @param dsp_addr I2C device address of the DSP.
+ * @param dsp Pointer to the ISL29501 driver instance.
  * @param eeprom_addr I2C device address of the EEPROM.
+ * @return 1: warm path taken; 0: cold path.
  */
-void ISL29501_initialize(I2cCore *ISL29501_p, uint8_t dsp_addr, uint8_t eeprom_addr) {
-    uint8_t wbytes[2], bytes[1];
+int ISL29501_initialize(I2cCore *ISL29501_p, Isl29501 *dsp, uint8_t eeprom_addr) {
+    uint8_t bytes[1], cal[CAL_LEN];
+    int mismatches, warm = 0, cal_status;
+
+    // Reading contents of omboard EEPROM (expected calibration)...
+    cal_status = read_eeprom_calibration(ISL29501_p, eeprom_addr, cal);
+    if (cal_status != 0) {
+        uart.disp("EEPROM calibration read failed (");
+        uart.disp(cal_status);
+        uart.disp("); calibration not copied\n\r");
+    } else {
+        // Check whether the DSP still holds calibration and configs...
+        for (int i = 0; i < CAL_LEN; i++)
+            dsp->expect(CAL_DSP_START + i, cal[i]);
+        for (int i = 0; i < NUM_DIGILENT_VALUES; i++)
+            dsp->expect(digilent_values[i][0], digilent_values[i][1]);
+        warm = (dsp->verify() == 0);
+    }
 
-    // Factory reset (Write 0xD7 to 0xB0 according to the data sheet...)
-    wbytes[0] = 0xB0;
-    wbytes[1] = 0xD7;
-    ISL29501_p->write_transaction(dsp_addr, wbytes, 2, 0);
+    if (!warm) {
+        // Factory reset (Write 0xD7 to 0xB0 according to the data sheet...)
+        dsp->command(Isl29501::SOFT_RESET_CMD);
 
-    // Reading contents of omboard EEPROM to the DSP...
-    read_eeprom_calibration(ISL29501_p, eeprom_addr, dsp_addr);
-    
-    // Writing digilent recommended DSP configs...
-    write_digilent_values(ISL29501_p, dsp_addr);
+        //Write calibration to DSP starting at address 0x24 to 0x30. (13 values, auto-increment...)
+        if (cal_status == 0)
+            dsp->write_block(CAL_DSP_START, cal, CAL_LEN);
+
+        // Writing digilent recommended DSP configs...
+        write_digilent_values(dsp);
+    }
+
+    // Verify calibration and configs in burst readbacks...
+    mismatches = dsp->verify();
+    uart.disp(warm ? "Warm boot (reset/copy skipped)" : "Cold boot");
+    uart.disp(", DSP config verify: ");
+    uart.disp(mismatches);
+    uart.disp(" mismatch(es), ");
+    uart.disp(dsp->verify_bursts());
+    uart.disp(" burst(s)\n\r");
 
     // Display Device ID
-    easy_read_transaction(ISL29501_p, dsp_addr, 0x00, bytes, 1);
+    dsp->read_reg(Isl29501::DEV_ID_REG, bytes);
     uart.disp("Device ID: 0x");
     uart.disp(bytes[0], 16);
     uart.disp("\n\r");
-
-    
+    return warm;
 }
 
 /**
- * Reads the distance from the ISL29501 DSP in meters, centimeters, and inches.
+ * Issues a "SAMPLE START" to the DSP.
+ *
+ * In single-shot mode this starts one conversion; in continuous mode
+ * it starts the free-running conversions.
  *
  * @param ISL29501_p Pointer to the I2C core instance.
+ * @param intc_p Pointer to the interrupt controller instance.
  * @param dsp_addr I2C device address of the DSP.
  */
-double ISL29501_read_distance(I2cCore *ISL29501_p, uint8_t dsp_addr) {
-    uint8_t wbytes[2], bytes[1];
-    uint16_t distanceMSB, distanceLSB;
-    double distance;
+void ISL29501_sample_start(I2cCore *ISL29501_p, IntcCore *intc_p, uint8_t dsp_addr) {
+    uint8_t wbytes[2];
+    PROF_SCOPE(PH_START);
 
-    //Simulate a "SAMPLE START" as per the datasheet...
+    intc_p->ack(TOF_IRQ_SRC);    //Drop any stale data-ready edge...
     wbytes[0] = 0xB0;
     wbytes[1] = 0x49; 
     ISL29501_p->write_transaction(dsp_addr, wbytes, 2, 0);
+}
 
-    //Read 16 bit distance registers at 0xD1 and 0xD2...
-    easy_read_transaction(ISL29501_p, dsp_addr, 0xD1, bytes, 1);
-    distanceMSB = bytes[0];
-    easy_read_transaction(ISL29501_p, dsp_addr, 0xD2, bytes, 1);
-    distanceLSB = bytes[0];
+/**
+ * Switches the DSP between single-shot and continuous conversion.
+ *
+ * Continuous mode programs the Sample Period (0x11) and clears the
+ * single-shot bit of Sample Control (0x13), then starts the conversions.
+ * Registers already holding the value are not rewritten.
+ *
+ * @param dsp Pointer to the ISL29501 driver instance.
+ * @param intc_p Pointer to the interrupt controller instance.
+ * @param continuous 1: free-running; 0: single-shot.
+ */
+void ISL29501_set_mode(Isl29501 *dsp, IntcCore *intc_p, int continuous) {
+    dsp->write_reg(Isl29501::SAMPLE_PERIOD_REG, ISL29501_SAMPLE_PERIOD);
+    dsp->write_reg(Isl29501::SAMPLE_CTRL_REG,
+                   continuous ? ISL29501_SAMPLE_CTRL_CONT : ISL29501_SAMPLE_CTRL_CONT | 0x01);
+    if (continuous) {
+        intc_p->ack(TOF_IRQ_SRC);    //Drop any stale data-ready edge...
+        dsp->command(Isl29501::SAMPLE_START_CMD);
+    }
+}
 
-    uart.disp("[");
-    uart.disp(distanceMSB);
-    uart.disp(",");
-    uart.disp(distanceLSB);
-    uart.disp("] ");
-    //Calculate distance according to datasheet...
-    return distance = ((double)(distanceMSB * 256 + distanceLSB) / 65536) * 33.31;
+/**
+ * Converts a raw distance sample (0xD1/0xD2) into micrometers.
+ *
+ * Full scale is 33.31 m over 2^16 codes, i.e. raw * 33310000 / 65536
+ * = raw * 2081875 / 4096 = raw * 508 + raw * 1107 / 4096 (exact floor,
+ * all terms within 32 bits; no floating point).
+ *
+ * @param raw 16-bit raw distance.
+ */
+uint32_t ISL29501_raw_to_um(uint16_t raw) {
+    PROF_SCOPE(PH_CONVERT);
+    return (uint32_t)raw * 508 + (((uint32_t)raw * 1107) >> 12);
+}
+
+/**
+ * Output mode and status of the sample being read...
+ * tlm_binary: 1: binary frames; 0: text.
+ * tof_status: TLM_* flags raised while reading the current sample.
+ */
+int tlm_binary = TOF_TELEMETRY;
+uint8_t tof_status = 0;
+
+/**
+ * Reads the next raw distance (0xD1/0xD2) from the ISL29501 DSP.
+ *
+ * The result is read on the data-ready edge of the DSP IRQ line (latched
+ * by the MCS interrupt controller), so the registers are read once the
+ * conversion has finished. No sample start is issued; in continuous mode
+ * this is all the firmware does per sample.
+ * The result registers are read as one block (distance MSB/LSB followed
+ * by the precision MSB/LSB) in a single write-then-read bus transaction;
+ * the DSP auto-increments the register address.
+ *
+ * @param ISL29501_p Pointer to the I2C core instance.
+ * @param intc_p Pointer to the interrupt controller instance.
+ * @param dsp_addr I2C device address of the DSP.
+ */
+uint16_t ISL29501_read_result(I2cCore *ISL29501_p, IntcCore *intc_p, uint8_t dsp_addr) {
+    uint8_t wbytes[1], bytes[ISL29501_RESULT_LEN];
+
+    //Wait for the data-ready edge, then release the IRQ line...
+    tof_status = 0;
+    PROF_BEGIN(PH_WAIT);
+    if (intc_p->wait(TOF_IRQ_SRC, TOF_IRQ_TIMEOUT_US) != 0)
+        tof_status |= TLM_TIMEOUT;
+    PROF_END(PH_WAIT);
+    PROF_SCOPE(PH_RESULT);
+    wbytes[0] = ISL29501_IRQ_STAT_REG;
+    ISL29501_p->write_read_transaction(dsp_addr, wbytes, 1, bytes, 1);
+
+    //Read 16 bit distance registers at 0xD1 and 0xD2 (plus precision) in one burst...
+    wbytes[0] = ISL29501_RESULT_REG;
+    if (ISL29501_p->write_read_transaction(dsp_addr, wbytes, 1, bytes, ISL29501_RESULT_LEN) != 0)
+        tof_status |= TLM_NACK;
+    return bytes[0] * 256 + bytes[1];
+}
+
+/**
+ * Starts a non-blocking read of the next result block.
+ *
+ * Waits for the data-ready edge and releases the IRQ line, then submits
+ * the result block read and pushes it to the bus; the caller completes it
+ * with ISL29501_p->poll() and can do other work in between.
+ *
+ * @param ISL29501_p Pointer to the I2C core instance.
+ * @param intc_p Pointer to the interrupt controller instance.
+ * @param dsp_addr I2C device address of the DSP.
+ * @param xfer Pointer to the transaction descriptor.
+ * @param bytes Buffer for the ISL29501_RESULT_LEN result bytes.
+ */
+void ISL29501_submit_result(I2cCore *ISL29501_p, IntcCore *intc_p, uint8_t dsp_addr,
+                            i2c_xfer_t *xfer, uint8_t *bytes) {
+    static uint8_t result_reg = ISL29501_RESULT_REG;
+    uint8_t wbytes[1], stat[1];
+
+    tof_status = 0;
+    PROF_BEGIN(PH_WAIT);
+    if (intc_p->wait(TOF_IRQ_SRC, TOF_IRQ_TIMEOUT_US) != 0)
+        tof_status |= TLM_TIMEOUT;
+    PROF_END(PH_WAIT);
+    wbytes[0] = ISL29501_IRQ_STAT_REG;
+    ISL29501_p->write_read_transaction(dsp_addr, wbytes, 1, stat, 1);
+
+    xfer->dev = dsp_addr;
+    xfer->wbytes = &result_reg;
+    xfer->wnum = 1;
+    xfer->rbytes = bytes;
+    xfer->rnum = ISL29501_RESULT_LEN;
+    xfer->rstart = 0;
+    xfer->done = 0;
+    xfer->arg = 0;
+    ISL29501_p->submit(xfer);
+    ISL29501_p->poll();
+}
+
+/**
+ * Reads the raw distance from the ISL29501 DSP (single-shot mode).
+ *
+ * @param ISL29501_p Pointer to the I2C core instance.
+ * @param intc_p Pointer to the interrupt controller instance.
+ * @param dsp_addr I2C device address of the DSP.
+ */
+uint16_t ISL29501_read_distance(I2cCore *ISL29501_p, IntcCore *intc_p, uint8_t dsp_addr) {
+    //Simulate a "SAMPLE START" as per the datasheet...
+    ISL29501_sample_start(ISL29501_p, intc_p, dsp_addr);
+    return ISL29501_read_result(ISL29501_p, intc_p, dsp_addr);
+}
 
+#if TOF_SCHED_PERIOD_US
+PeriodicSched tof_sched;
+
+/**
+ * Prints and clears the scheduler statistics: release latency
+ * (min/mean/max, clock cycles), jitter (max - min), overruns and
+ * releases skipped.
+ */
+void report_sched_stat() {
+    sched_stat_t st;
+
+    tof_sched.get_stat(&st);
+    tof_sched.clear_stat();
+    if (st.n == 0)
+        return;
+    uart.disp("sched: latency ");
+    uart.disp((int)st.lat_min);
+    uart.disp("/");
+    uart.disp((int)(uint32_t)(st.lat_sum / st.n));
+    uart.disp("/");
+    uart.disp((int)st.lat_max);
+    uart.disp(" clk, jitter ");
+    uart.disp((int)(st.lat_max - st.lat_min));
+    uart.disp(" clk, overruns ");
+    uart.disp((int)st.overruns);
+    uart.disp(", skipped ");
+    uart.disp((int)st.skipped);
+    uart.disp("\n\r");
+}
+#endif
+
+/**
+ * Counts one sample and reports the measured rate every RATE_WINDOW_MS
+ * (with the scheduler statistics if the single-shot loop is scheduled).
+ * The first call also reports the time from boot to the first sample.
+ * Nothing is printed in binary output mode.
+ *
+ * @param mode Name of the acquisition mode printed with the rate.
+ */
+void report_sample_rate(const char *mode) {
+    static sys_clock::time_point t0;
+    static int n = 0;
+    sys_clock::time_point now = sys_clock::now();
+
+    // window in clock cycles; the rate divide runs once per report
+    if (n == 0 && t0.time_since_epoch().count() == 0) {
+        // system timer runs from reset: first call gives boot-to-first-sample
+        if (!tlm_binary) {
+            uart.disp("Boot to first sample: ");
+            uart.disp((int)now_us());
+            uart.disp(" us\n\r");
+        }
+        t0 = now;
+    }
+    n++;
+    if (now - t0 >= std::chrono::milliseconds(RATE_WINDOW_MS)) {
+        if (!tlm_binary) {    // no text inside the frame stream
+            uart.disp(mode);
+            uart.disp(": ");
+            uart.disp((int)(n * to_ticks(std::chrono::seconds(1)) / (now - t0).count()));
+            uart.disp(" samples/s\n\r");
+#if TOF_SCHED_PERIOD_US
+            report_sched_stat();
+#endif
+        }
+        n = 0;
+        t0 = now;
+    }
 }
 
-void double_to_sseg(SsegCore *sseg, double adc_voltage)
+/**
+ * Shows a distance on the seven-segment display as "MM.mm" (meters).
+ *
+ * @param sseg Pointer to the seven-segment core instance.
+ * @param um Distance in micrometers.
+ */
+void um_to_sseg(SsegCore *sseg, uint32_t um)
 {
+    PROF_SCOPE(PH_SSEG);
+
     // Turn off unneeded SSeg displays (positions 0–3)
     for (int i = 3; i >= 0; --i)
         sseg->write_1ptn(0xff, i); // Active LOW
@@ -204,47 +477,45 @@ void double_to_sseg(SsegCore *sseg, double adc_voltage)
     // Set the decimal point: Place it between the 6th and 7th digits
     sseg->set_dp(0b01000000);  // Binary representation for decimal point at position 6
 
-    // Extract integer and fractional parts of adc_voltage
-    int integer_part = (int)adc_voltage; // Whole number part
-    int fractional_part = (int)((adc_voltage - integer_part) * 1000); // First three decimal places
+    // Extract integer meters and centimeters
+    uint32_t integer_part = um / 1000000;            // Whole meters
+    uint32_t fractional_part = (um % 1000000) / 10000; // Two decimal places
 
     // Display integer part (7th and 6th positions)
-    uint8_t upper_disp_val = sseg->h2s(integer_part / 10); // Tens place of integer part
-    sseg->write_1ptn(upper_disp_val, 7);
+    sseg->write_1ptn(sseg->h2s(integer_part / 10), 7); // Tens place of integer part
+    sseg->write_1ptn(sseg->h2s(integer_part % 10), 6); // Ones place of integer part
 
-    uint8_t lower_disp_val = sseg->h2s(integer_part % 10); // Ones place of integer part
-    sseg->write_1ptn(lower_disp_val, 6);
-
-    // Display fractional part (5th, 4th, and 3rd positions)
-    uint8_t frac_first = sseg->h2s((fractional_part / 100) % 10); // Tenths place
-    sseg->write_1ptn(frac_first, 5);
-
-    uint8_t frac_second = sseg->h2s((fractional_part / 10) % 10); // Hundredths place
-    sseg->write_1ptn(frac_second, 4);
+    // Display fractional part (5th and 4th positions)
+    sseg->write_1ptn(sseg->h2s(fractional_part / 10), 5); // Tenths place
+    sseg->write_1ptn(sseg->h2s(fractional_part % 10), 4); // Hundredths place
 }
 
-void print_distance(double distance) {
-    double distance_cm = distance * 100;     //Calculate cm...
-    double distance_in = distance * 39.3701; //Calculate in...
+/**
+ * Prints a distance in meters, centimeters and inches.
+ *
+ * @param um Distance in micrometers.
+ */
+void print_distance(uint32_t um) {
+    uint32_t distance_in = um * 50 / 127;    //Calculate in (x 10^-4): um / 25.4 / 100...
 
     // Use colors for output
     uart.disp(GREEN);
     uart.disp("Distance:");
     uart.disp(RESET);
     uart.disp(" ");
-    uart.disp(distance, 10);
+    uart.disp_fixed(um, 6);                  //m, all six digits exact
     uart.disp(" ");
     uart.disp(BLUE);
     uart.disp("m");
     uart.disp(RESET);
     uart.disp(", ");
-    uart.disp(distance_cm, 10);
+    uart.disp_fixed(um, 4);                  //cm = um / 10^4
     uart.disp(" ");
     uart.disp(YELLOW);
     uart.disp("cm");
     uart.disp(RESET);
     uart.disp(", ");
-    uart.disp(distance_in, 10);
+    uart.disp_fixed(distance_in, 4);
     uart.disp(" ");
     uart.disp(RED);
     uart.disp("in");
@@ -252,20 +523,273 @@ void print_distance(double distance) {
     uart.disp("\n\r");
 }
 
+/**
+ * Switches the output mode on a 'b' (binary) or 't' (text) received
+ * on the uart; 'p' prints and 'r' clears the phase profile (if compiled
+ * in); other characters are ignored.
+ */
+void check_output_mode() {
+    int c = uart.rx_byte();
+
+    if (c == 'b')
+        tlm_binary = 1;
+    else if (c == 't')
+        tlm_binary = 0;
+    else if (c == 'p')
+        PROF_REPORT(&uart);
+    else if (c == 'r')
+        PROF_RESET();
+}
+
+/**
+ * Sends one sample in the current output mode.
+ *
+ * Binary: one TLM_FRAME_LEN-byte frame (sync, sequence number, time stamp,
+ * raw distance, status, CRC). Text: status, raw bytes and print_distance().
+ *
+ * @param tick Time stamp (32 LSBs of the system clock count).
+ * @param raw 16-bit raw distance.
+ * @param status TLM_* flags.
+ */
+void emit_sample(uint32_t tick, uint16_t raw, uint8_t status) {
+    PROF_SCOPE(PH_UART);
+
+    if (tlm_binary) {
+        tlm_send(&uart, tick, raw, status);
+        return;
+    }
+    if (status & TLM_OVERFLOW)
+        uart.disp("[overflow] ");
+    if (status & TLM_TIMEOUT)
+        uart.disp("[irq timeout] ");
+    if (status & TLM_NACK) {
+        uart.disp("[nack]\n\r");
+        return;
+    }
+    uart.disp("[");
+    uart.disp(raw >> 8);
+    uart.disp(",");
+    uart.disp(raw & 0xff);
+    uart.disp("] ");
+    print_distance(ISL29501_raw_to_um(raw));
+}
+
+/**
+ * Time stamp of the current sample: 32 LSBs of the system clock count
+ * captured by the timer on the data-ready edge (one register read, no
+ * software timing in the sample path); the current count if the edge
+ * timed out.
+ */
+uint32_t sample_tick() {
+    if (tof_status & TLM_TIMEOUT)
+        return (uint32_t)now_tick();
+    return capture_tick();
+}
+
+#if TOF_BENCH
+volatile uint32_t bench_sink;
+
+/**
+ * Times the per-sample conversion work (raw to meters/cm/in plus the
+ * seven-segment digits) with soft-float and with fixed-point arithmetic
+ * and prints the clock cycles per sample of each.
+ */
+void bench_distance_pipeline() {
+    unsigned long t0, t_float, t_fixed;
+    uint16_t raw;
+
+    t0 = now_us();
+    for (int i = 0; i < TOF_BENCH_N; i++) {
+        raw = (uint16_t)(i * 61);
+        double distance = ((double)raw / 65536) * 33.31;
+        double distance_cm = distance * 100;
+        double distance_in = distance * 39.3701;
+        int integer_part = (int)distance;
+        int fractional_part = (int)((distance - integer_part) * 1000);
+        bench_sink = (uint32_t)distance_cm + (uint32_t)distance_in + fractional_part;
+    }
+    t_float = now_us() - t0;
+
+    t0 = now_us();
+    for (int i = 0; i < TOF_BENCH_N; i++) {
+        raw = (uint16_t)(i * 61);
+        uint32_t um = ISL29501_raw_to_um(raw);
+        uint32_t distance_in = um * 50 / 127;
+        uint32_t integer_part = um / 1000000;
+        uint32_t fractional_part = (um % 1000000) / 10000;
+        bench_sink = um / 10000 + distance_in + integer_part + fractional_part;
+    }
+    t_fixed = now_us() - t0;
+
+    uart.disp("Distance pipeline (cycles/sample): soft-float ");
+    uart.disp((int)(t_float * SYS_CLK_FREQ / TOF_BENCH_N));
+    uart.disp(", fixed-point ");
+    uart.disp((int)(t_fixed * SYS_CLK_FREQ / TOF_BENCH_N));
+    uart.disp("\n\r");
+}
+#endif
+
 I2cCore ISL29501(get_slot_addr(BRIDGE_BASE, S4_USER));
 SsegCore sseg(get_slot_addr(BRIDGE_BASE, S8_SSEG));
+TofAcqCore tof_acq(get_slot_addr(BRIDGE_BASE, S14_TOF_ACQ));
+IntcCore intc(IOMODULE_BASE);
+Isl29501 tof_dsp(&ISL29501, dev_PMOD_RENESAS_DSP);
+#if TOF_MULTI
+I2cCore ISL29501_2(get_slot_addr(BRIDGE_BASE, S10_I2C));
+Isl29501 tof_dsp2(&ISL29501_2, dev_PMOD_RENESAS_DSP);
+TofArray tof_array;
+#endif
 
 int main() {
 
-    ISL29501_initialize(&ISL29501, dev_PMOD_RENESAS_DSP, dev_PMOD_EEPROM);
+    PROF_NAME(PH_SAMPLE, "sample");
+    PROF_NAME(PH_START, "start");
+    PROF_NAME(PH_WAIT, "wait");
+    PROF_NAME(PH_RESULT, "result");
+    PROF_NAME(PH_CONVERT, "convert");
+    PROF_NAME(PH_UART, "uart");
+    PROF_NAME(PH_SSEG, "sseg");
+    PROF_NAME(PH_DRAIN, "drain");
+    ISL29501_initialize(&ISL29501, &tof_dsp, dev_PMOD_EEPROM);
     SsegCore sseg(get_slot_addr(BRIDGE_BASE, S8_SSEG));
 
+    // Raise the bus clock to the fastest rate the DSP reads back reliably...
+    int i2c_freq = ISL29501.probe_freq(dev_PMOD_RENESAS_DSP, 0x00, 16);
+    uart.disp("I2C clock: ");
+    uart.disp(i2c_freq);
+    uart.disp(" Hz\n\r");
+#if TOF_BENCH
+    bench_distance_pipeline();
+#endif
+
+#if TOF_MULTI
+    /*Sensors on both buses run interleaved: one is read out while the
+      others convert; each sensor keeps its own time-stamped stream...*/
+    tof_sample_t tof_samples[TofArray::STREAM_LEN];
+
+    ISL29501_initialize(&ISL29501_2, &tof_dsp2, dev_PMOD_EEPROM);
+    ISL29501_2.probe_freq(dev_PMOD_RENESAS_DSP, 0x00, 16);
+    tof_array.add(&ISL29501, dev_PMOD_RENESAS_DSP);
+    tof_array.add(&ISL29501_2, dev_PMOD_RENESAS_DSP);
+    tof_array.set_period(TOF_MULTI_PERIOD_US);
+    tof_array.set_conv_wait(TOF_MULTI_CONV_US);
+    tof_array.start();
+    while (1) {
+        tof_array.poll();
+        uart.tx_poll();
+        check_output_mode();
+        for (int id = 0; id < 2; id++) {
+            int n = tof_array.read(id, tof_samples, TofArray::STREAM_LEN);
+            uint8_t status = TLM_SENSOR(id) | (tof_array.overflow(id) ? TLM_OVERFLOW : 0);
+            for (int i = 0; i < n; i++) {
+                if (!tlm_binary) {
+                    uart.disp("[sensor ");
+                    uart.disp(id);
+                    uart.disp(" @ ");
+                    uart.disp((int)tof_samples[i].tick);
+                    uart.disp("] ");
+                }
+                emit_sample(tof_samples[i].tick, tof_samples[i].raw,
+                            status | (tof_samples[i].nack ? TLM_NACK : 0));
+                status &= ~TLM_OVERFLOW;
+            }
+        }
+    }
+#endif
+
+#if TOF_ACQ_HW
+    /*The acquisition engine issues sample start and result reads on its own;
+      the CPU only drains time-stamped samples from its FIFO...*/
+    tof_sample_t samples[TOF_ACQ_BURST];
+
+    while (!ISL29501.ready()) {}     // engine takes over an idle i2c master
+    tof_acq.set_dev(dev_PMOD_RENESAS_DSP);
+    tof_acq.set_period(TOF_ACQ_PERIOD_US);
+    tof_acq.set_conv_wait(TOF_ACQ_CONV_US);
+    tof_acq.enable();
+    while (1) {
+        int n = tof_acq.read_samples(samples, TOF_ACQ_BURST);
+        uint8_t status = tof_acq.overflow() ? TLM_OVERFLOW : 0;
+        uart.tx_poll();
+        check_output_mode();
+        for (int i = 0; i < n; i++) {
+            if (!tlm_binary) {
+                uart.disp("[");
+                uart.disp((int)samples[i].tick);
+                uart.disp("] ");
+            }
+            emit_sample(samples[i].tick, samples[i].raw,
+                        status | (samples[i].nack ? TLM_NACK : 0));
+            status = 0;
+            if (samples[i].nack)
+                continue;
+            if (i == n - 1)
+                um_to_sseg(&sseg, ISL29501_raw_to_um(samples[i].raw));
+            report_sample_rate("engine");
+        }
+    }
+#endif
+
+    intc.enable(TOF_IRQ_SRC);
+    capture_select(TimerCore::CAP_TOF_IRQ);
+    ISL29501_set_mode(&tof_dsp, &intc, TOF_CONTINUOUS);
+#if TOF_CONTINUOUS
+    /*DSP converts on its own at the sample period; firmware only drains
+      the result registers on each data-ready edge. The result read runs on
+      the bus while the previous sample is printed/displayed. The first
+      result is read before the loop so only read samples are emitted...*/
+    i2c_xfer_t result_xfer;
+    uint8_t result[ISL29501_RESULT_LEN];
+    uint16_t raw;
+    uint32_t tick;
+    uint8_t status;
+
+    ISL29501_submit_result(&ISL29501, &intc, dev_PMOD_RENESAS_DSP, &result_xfer, result);
+    while (ISL29501.poll())
+        uart.tx_poll();
+    while (1) {
+        PROF_BEGIN(PH_SAMPLE);
+        tick = sample_tick();
+        raw = result[0] * 256 + result[1];
+        status = tof_status | (result_xfer.status != 0 ? TLM_NACK : 0);
+        ISL29501_submit_result(&ISL29501, &intc, dev_PMOD_RENESAS_DSP, &result_xfer, result);
+        uart.tx_poll();
+        check_output_mode();
+        emit_sample(tick, raw, status);
+        um_to_sseg(&sseg, ISL29501_raw_to_um(raw));
+        report_sample_rate("continuous");
+        PROF_BEGIN(PH_DRAIN);
+        while (ISL29501.poll())
+            uart.tx_poll();
+        PROF_END(PH_DRAIN);
+        PROF_END(PH_SAMPLE);
+    }
+#endif
+
     /*We are running in single-shot mode, acquisition is handled by microcontroller, 
-      DSP is not continuously unless CPU tells it to...*/
+      DSP is not continuously unless CPU tells it to. With a scheduler period
+      each sample starts on its release; the tx ring drains while waiting...*/
+#if TOF_SCHED_PERIOD_US
+    tof_sched.set_period(TOF_SCHED_PERIOD_US);
+    tof_sched.set_policy(TOF_SCHED_POLICY);
+    tof_sched.start();
+#endif
     while (1) {
-        double distance = ISL29501_read_distance(&ISL29501, dev_PMOD_RENESAS_DSP);
-        print_distance(distance);
-        double_to_sseg(&sseg, distance);
+#if TOF_SCHED_PERIOD_US
+        while (!tof_sched.due()) {
+            uart.tx_poll();
+            check_output_mode();
+        }
+#endif
+        PROF_BEGIN(PH_SAMPLE);
+        uint16_t raw = ISL29501_read_distance(&ISL29501, &intc, dev_PMOD_RENESAS_DSP);
+        uint32_t tick = sample_tick();
+        uart.tx_poll();
+        check_output_mode();
+        emit_sample(tick, raw, tof_status);
+        um_to_sseg(&sseg, ISL29501_raw_to_um(raw));
+        report_sample_rate("single-shot");
+        PROF_END(PH_SAMPLE);
     }
 
 
@@ -0,0 +1,112 @@
+/*****************************************************************//**
+ * @file num_fmt.cpp
+ *
+ * @brief implementation of division-free number formatting
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "num_fmt.h"
+
+static const uint32_t pow10_table[10] = {
+   1000000000, 100000000, 10000000, 1000000, 100000,
+   10000, 1000, 100, 10, 1
+};
+
+static const char digit_table[16] = {
+   '0', '1', '2', '3', '4', '5', '6', '7',
+   '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'
+};
+
+int fmt_udec(char *buf, uint32_t un, int min_digits) {
+   int i, n = 0;
+   uint32_t p;
+   char d;
+
+   if (min_digits < 1)
+      min_digits = 1;
+   if (min_digits > 10)
+      min_digits = 10;
+   // skip leading zeros beyond min_digits
+   i = 0;
+   while (i < 10 - min_digits && un < pow10_table[i])
+      i++;
+   for (; i < 10; i++) {
+      p = pow10_table[i];
+      d = '0';
+      while (un >= p) {
+         un = un - p;
+         d++;
+      }
+      buf[n++] = d;
+   }
+   return (n);
+}
+
+/* base 2^shift digits, most significant first */
+static int fmt_pow2(char *buf, uint32_t un, int shift) {
+   char tmp[32];
+   uint32_t mask = (1 << shift) - 1;
+   int i = 0, n = 0;
+
+   do {
+      tmp[i++] = digit_table[un & mask];
+      un = un >> shift;
+   } while (un);
+   while (i > 0)
+      buf[n++] = tmp[--i];
+   return (n);
+}
+
+int fmt_int(char *buf, int n, int base, int len) {
+   char digits[33];
+   uint32_t un;
+   int i, num, k = 0;
+   int neg = 0;
+
+   if (len > 32)
+      len = 32;
+   if (base == 10 || (base != 2 && base != 8 && base != 16)) {
+      neg = (n < 0);
+      un = neg ? (uint32_t) -n : (uint32_t) n;
+      num = fmt_udec(digits + neg, un, 1);
+   } else {
+      un = (uint32_t) n; // interpreted as unsigned for hex/bin conversion
+      num = fmt_pow2(digits, un, (base == 2) ? 1 : (base == 8) ? 3 : 4);
+   }
+   /* attach - sign for neg decimal # */
+   if (neg) {
+      digits[0] = '-';
+      num++;
+   }
+   /* pad with blank */
+   for (i = num; i < len; i++)
+      buf[k++] = ' ';
+   for (i = 0; i < num; i++)
+      buf[k++] = digits[i];
+   return (k);
+}
+
+int fmt_fixed(char *buf, int n, int frac) {
+   char digits[10];
+   uint32_t un;
+   int num, i, k = 0;
+
+   if (frac > 9)
+      frac = 9;
+   if (frac < 0)
+      frac = 0;
+   un = (n < 0) ? (uint32_t) -n : (uint32_t) n;
+   if (n < 0)
+      buf[k++] = '-';
+   // at least one integer digit; fraction zero-padded
+   num = fmt_udec(digits, un, frac + 1);
+   for (i = 0; i < num - frac; i++)
+      buf[k++] = digits[i];
+   if (frac > 0) {
+      buf[k++] = '.';
+      for (; i < num; i++)
+         buf[k++] = digits[i];
+   }
+   return (k);
+}
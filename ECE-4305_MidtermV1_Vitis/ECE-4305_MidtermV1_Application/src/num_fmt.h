@@ -0,0 +1,64 @@
+/*****************************************************************//**
+ * @file num_fmt.h
+ *
+ * @brief division-free number to text conversion
+ *
+ * Description:
+ * - render integers, fixed-point decimals and hex/octal/binary
+ *   numbers into a caller's char buffer
+ * - decimal digits by subtracting powers of ten (at most 9 subtractions
+ *   per digit); hex/octal/binary by shifts and a digit table
+ * - no division, modulo or multiplication; the MicroBlaze MCS has no
+ *   hardware divider/multiplier/barrel shifter (-mxl-soft-mul) and
+ *   "/" and "%" go through library routines
+ * - output is not null-terminated; the length is returned so the
+ *   text can be sent with one bulk write
+ * - no target dependency; also compiled by the host benchmark
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _NUM_FMT_H_INCLUDED
+#define _NUM_FMT_H_INCLUDED
+
+#include <stdint.h>
+
+#define FMT_BUF_LEN 40   // enough for any fmt_*() output
+
+/**
+ * render an unsigned number in decimal
+ *
+ * @param buf output buffer
+ * @param un number
+ * @param min_digits # digits; leading zeros added if needed (up to 10)
+ * @return # chars written
+ *
+ */
+int fmt_udec(char *buf, uint32_t un, int min_digits);
+
+/**
+ * render an integer (same format as UartCore::disp(n, base, len))
+ *
+ * @param buf output buffer (FMT_BUF_LEN)
+ * @param n integer
+ * @param base 2/8/10/16; others treated as 10
+ * @param len # chars; padding blanks added in front (up to 32)
+ * @return # chars written
+ *
+ * @note negative numbers are signed in base 10, unsigned otherwise
+ *
+ */
+int fmt_int(char *buf, int n, int base, int len);
+
+/**
+ * render a fixed-point decimal (same format as UartCore::disp_fixed())
+ *
+ * @param buf output buffer (FMT_BUF_LEN)
+ * @param n value scaled by 10^frac
+ * @param frac # digits in fraction portion (0 to 9)
+ * @return # chars written
+ *
+ */
+int fmt_fixed(char *buf, int n, int frac);
+
+#endif  // _NUM_FMT_H_INCLUDED
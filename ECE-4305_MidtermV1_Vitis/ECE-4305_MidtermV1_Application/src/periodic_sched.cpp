@@ -0,0 +1,92 @@
+/*****************************************************************//**
+ * @file periodic_sched.cpp
+ *
+ * @brief implementation of PeriodicSched class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "periodic_sched.h"
+
+PeriodicSched::PeriodicSched() {
+   period = 10000 * SYS_CLK_FREQ;
+   period_set = period;
+   policy = SKIP;
+   running = 0;
+   t_next = 0;
+   t_rel = 0;
+   clear_stat();
+}
+
+PeriodicSched::~PeriodicSched() {
+}
+
+void PeriodicSched::set_period(uint32_t us) {
+   period_set = (uint64_t) us * SYS_CLK_FREQ;
+   if (period_set == 0)
+      period_set = 1;
+}
+
+void PeriodicSched::set_policy(int policy) {
+   this->policy = policy;
+}
+
+void PeriodicSched::start() {
+   clear_stat();
+   period = period_set;
+   t_next = now_tick();
+   running = 1;
+}
+
+int PeriodicSched::due() {
+   uint64_t now, late;
+
+   if (!running)
+      return (0);
+   now = now_tick();
+   if (now < t_next)
+      return (0);
+   late = now - t_next;
+   if (late >= period) {
+      stat.overruns++;
+      if (policy == SKIP) {
+         // step to the last slot passed; no divider on the MCS
+         while (late >= period) {
+            t_next += period;
+            late -= period;
+            stat.skipped++;
+         }
+      }
+   }
+   t_rel = t_next;
+   t_next += period;
+   if (stat.n == 0 || late < stat.lat_min)
+      stat.lat_min = (uint32_t) late;
+   if (late > stat.lat_max)
+      stat.lat_max = (uint32_t) late;
+   stat.lat_sum += late;
+   stat.n++;
+   return (1);
+}
+
+void PeriodicSched::wait() {
+   while (!due()) {
+   }
+}
+
+uint64_t PeriodicSched::release_tick() {
+   return (t_rel);
+}
+
+void PeriodicSched::get_stat(sched_stat_t *st) {
+   *st = stat;
+}
+
+void PeriodicSched::clear_stat() {
+   stat.n = 0;
+   stat.lat_min = 0;
+   stat.lat_max = 0;
+   stat.lat_sum = 0;
+   stat.overruns = 0;
+   stat.skipped = 0;
+}
@@ -0,0 +1,137 @@
+/*****************************************************************//**
+ * @file periodic_sched.h
+ *
+ * @brief fixed-rate release of a periodic task on the system timer
+ *
+ * Description:
+ * - releases are on a grid of the period from start(); the grid is in
+ *   clock cycles (now_tick()) and does not drift with the task time
+ * - due() is polled from the main loop; it returns 1 once per release
+ * - a pass that runs past the next release is an overrun; the policy
+ *   selects what happens to the missed releases:
+ *   - SKIP: dropped; the next release is the next slot on the grid
+ *   - CATCH_UP: kept; due() returns 1 back-to-back until caught up
+ * - statistics: # releases, release latency (poll time minus grid time)
+ *   min/max/sum, # overruns and # skipped releases
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _PERIODIC_SCHED_H_INCLUDED
+#define _PERIODIC_SCHED_H_INCLUDED
+
+#include "chu_init.h"
+
+/**
+ * scheduler statistics
+ *
+ * @note jitter is max - min of the release latency
+ */
+typedef struct {
+   uint32_t n;          /**< # releases */
+   uint32_t lat_min;    /**< min release latency (clk) */
+   uint32_t lat_max;    /**< max release latency (clk) */
+   uint64_t lat_sum;    /**< sum of release latencies (clk) */
+   uint32_t overruns;   /**< # releases found a period or more late */
+   uint32_t skipped;    /**< # releases dropped by the SKIP policy */
+} sched_stat_t;
+
+/**
+ * periodic scheduler
+ * - set period and policy, start, poll due() from the main loop
+ * - read and clear the statistics
+ *
+ */
+class PeriodicSched {
+public:
+   /**
+    * overrun policies
+    *
+    */
+   enum {
+      SKIP = 0,      /**< drop missed releases; keep the grid */
+      CATCH_UP = 1   /**< run missed releases back-to-back */
+   };
+   /* methods */
+   /**
+    * constructor
+    *
+    * @note defaults: 10 ms period, SKIP policy, not started
+    */
+   PeriodicSched();
+   ~PeriodicSched();                  // not used
+
+   /**
+    * set release period
+    *
+    * @param us period in microsecond
+    *
+    * @note takes effect at the next start(); a running grid keeps
+    *       its period
+    */
+   void set_period(uint32_t us);
+
+   /**
+    * set overrun policy
+    *
+    * @param policy SKIP or CATCH_UP
+    *
+    */
+   void set_policy(int policy);
+
+   /**
+    * start the grid; the first release is due at once
+    *
+    * @note statistics are cleared
+    */
+   void start();
+
+   /**
+    * check for a release (never waits)
+    *
+    * @return 1: task released (run it now); 0: not yet
+    *
+    * @note call as often as possible; the poll interval adds to
+    *       the release latency
+    */
+   int due();
+
+   /**
+    * busy-wait for the next release
+    *
+    */
+   void wait();
+
+   /**
+    * grid time of the last release in clock cycles
+    *
+    * @note evenly spaced by the period; a time stamp free of the
+    *       release latency
+    */
+   uint64_t release_tick();
+
+   /**
+    * read statistics
+    *
+    * @param st pointer to statistics
+    *
+    */
+   void get_stat(sched_stat_t *st);
+
+   /**
+    * clear statistics
+    *
+    */
+   void clear_stat();
+
+private:
+   uint64_t period;     // clk
+   uint64_t period_set; // period of the next start() (clk)
+   uint64_t t_next;     // next release on the grid (clk)
+   uint64_t t_rel;      // last release on the grid (clk)
+   int policy;
+   int running;
+   sched_stat_t stat;
+};
+
+#endif  // _PERIODIC_SCHED_H_INCLUDED
@@ -0,0 +1,138 @@
+/*****************************************************************//**
+ * @file prof.cpp
+ *
+ * @brief phase statistics and report of the profiler
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "prof.h"
+
+#if PROF_ENABLE
+#include "chu_init.h"
+
+typedef struct {
+   const char *name;
+   uint64_t t0;         // begin time stamp (0: not running)
+   uint32_t n;          // # completed calls
+   uint32_t min;
+   uint32_t max;
+   uint64_t sum;
+   uint32_t hist[PROF_HIST_LEN];
+} prof_phase_t;
+
+static prof_phase_t phase[PROF_MAX_PHASES];
+static uint32_t overhead = 0xffffffff;   // clocks of an empty begin/end
+
+/* log2 bucket; shifts by one (no barrel shifter on the MCS) */
+static int prof_bucket(uint32_t d) {
+   int k = 0;
+
+   while (d > 1) {
+      d = d >> 1;
+      k++;
+   }
+   return k;
+}
+
+/* clocks of an empty begin/end pair; min of a few trials */
+static void prof_calibrate() {
+   uint64_t t0, t1;
+   uint32_t d;
+
+   overhead = 0;
+   for (int i = 0; i < 8; i++) {
+      t0 = now_tick();
+      t1 = now_tick();
+      d = (uint32_t) (t1 - t0);
+      if (i == 0 || d < overhead)
+         overhead = d;
+   }
+}
+
+void prof_name(int id, const char *name) {
+   if (id >= 0 && id < PROF_MAX_PHASES)
+      phase[id].name = name;
+}
+
+void prof_begin(int id) {
+   if (id < 0 || id >= PROF_MAX_PHASES)
+      return;
+   if (overhead == 0xffffffff)
+      prof_calibrate();
+   phase[id].t0 = now_tick();
+}
+
+void prof_end(int id) {
+   uint64_t t1 = now_tick();
+   prof_phase_t *p;
+   uint32_t d;
+
+   if (id < 0 || id >= PROF_MAX_PHASES)
+      return;
+   p = &phase[id];
+   if (p->t0 == 0)
+      return;
+   d = (uint32_t) (t1 - p->t0);
+   d = (d > overhead) ? d - overhead : 0;
+   p->t0 = 0;
+   if (p->n == 0 || d < p->min)
+      p->min = d;
+   if (d > p->max)
+      p->max = d;
+   p->sum += d;
+   p->n++;
+   p->hist[prof_bucket(d)]++;
+}
+
+void prof_reset() {
+   for (int i = 0; i < PROF_MAX_PHASES; i++) {
+      prof_phase_t *p = &phase[i];
+      p->t0 = 0;
+      p->n = p->min = p->max = 0;
+      p->sum = 0;
+      for (int k = 0; k < PROF_HIST_LEN; k++)
+         p->hist[k] = 0;
+   }
+}
+
+void prof_report(UartCore *uart_p) {
+   const char *name;
+   int len;
+
+   uart_p->tx_flush();        // room for the header
+   uart_p->disp("profile (clk @ ");
+   uart_p->disp(SYS_CLK_FREQ);
+   uart_p->disp(" MHz, ");
+   uart_p->disp((int) overhead);
+   uart_p->disp(" clk overhead removed)\n\r");
+   uart_p->disp("phase              n        min       mean        max\n\r");
+   for (int i = 0; i < PROF_MAX_PHASES; i++) {
+      prof_phase_t *p = &phase[i];
+      if (p->n == 0)
+         continue;
+      name = (p->name) ? p->name : "?";
+      uart_p->disp(name);
+      for (len = 0; name[len]; len++) {
+      }
+      for (; len < 12; len++)
+         uart_p->disp(' ');
+      uart_p->disp((int) p->n, 10, 8);
+      uart_p->disp((int) p->min, 10, 11);
+      uart_p->disp((int) (p->sum / p->n), 10, 11);
+      uart_p->disp((int) p->max, 10, 11);
+      uart_p->disp("\n\r   log2:");
+      for (int k = 0; k < PROF_HIST_LEN; k++) {
+         if (p->hist[k] == 0)
+            continue;
+         uart_p->disp(" ");
+         uart_p->disp(k);
+         uart_p->disp(":");
+         uart_p->disp((int) p->hist[k]);
+      }
+      uart_p->disp("\n\r");
+      uart_p->tx_flush();     // whole report, even past the ring size
+   }
+}
+
+#endif  // PROF_ENABLE
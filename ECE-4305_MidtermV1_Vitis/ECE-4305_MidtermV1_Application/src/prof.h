@@ -0,0 +1,105 @@
+/*****************************************************************//**
+ * @file prof.h
+ *
+ * @brief scoped phase profiler on the system timer
+ *
+ * Description:
+ * - a phase is a numbered code section (0 to PROF_MAX_PHASES-1)
+ *   timed by PROF_BEGIN()/PROF_END() or by PROF_SCOPE() for the rest
+ *   of the enclosing block
+ * - time stamps from now_tick() (TimerCore::read_tick() of the
+ *   system timer); the cost of one begin/end pair is measured at
+ *   the first use and removed from every result
+ * - per phase: # calls, min/max/mean clocks and a log2 histogram
+ *   (bucket k: 2^k to 2^(k+1)-1 clocks), all in static arrays
+ * - PROF_REPORT() prints the table over a uart
+ * - PROF_ENABLE 0 (default) compiles every macro to nothing;
+ *   set it to 1 here or with -DPROF_ENABLE=1
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _PROF_H_INCLUDED
+#define _PROF_H_INCLUDED
+
+#include <stdint.h>
+
+#ifndef PROF_ENABLE
+#define PROF_ENABLE 0
+#endif
+
+#define PROF_MAX_PHASES 16
+#define PROF_HIST_LEN   32     // log2 buckets of a 32-bit clock count
+
+#if PROF_ENABLE
+class UartCore;
+
+/**
+ * name a phase (printed in the report)
+ *
+ * @param id phase number
+ * @param name phase name (string must stay valid)
+ */
+void prof_name(int id, const char *name);
+
+/**
+ * start timing a phase
+ *
+ * @param id phase number
+ * @note an id out of range is ignored
+ */
+void prof_begin(int id);
+
+/**
+ * stop timing a phase and accumulate its statistics
+ *
+ * @param id phase number
+ * @note an end without a begin or an id out of range is ignored
+ */
+void prof_end(int id);
+
+/**
+ * clear all statistics (names are kept)
+ *
+ */
+void prof_reset();
+
+/**
+ * print the statistics of all phases that ran
+ *
+ * @param uart_p pointer to uart core
+ * @note one line per phase, then its non-empty histogram buckets
+ */
+void prof_report(UartCore *uart_p);
+
+/* times the enclosing block */
+class ProfScope {
+public:
+   ProfScope(int id) : id(id) { prof_begin(id); }
+   ~ProfScope() { prof_end(id); }
+private:
+   int id;
+};
+
+#define PROF_CAT2(a, b) a##b
+#define PROF_CAT(a, b) PROF_CAT2(a, b)
+
+#define PROF_NAME(id, name) prof_name((id), (name))
+#define PROF_BEGIN(id)      prof_begin(id)
+#define PROF_END(id)        prof_end(id)
+#define PROF_SCOPE(id)      ProfScope PROF_CAT(prof_scope_, __LINE__)(id)
+#define PROF_RESET()        prof_reset()
+#define PROF_REPORT(uart_p) prof_report(uart_p)
+
+#else  // not PROF_ENABLE
+
+#define PROF_NAME(id, name) ((void) 0)
+#define PROF_BEGIN(id)      ((void) 0)
+#define PROF_END(id)        ((void) 0)
+#define PROF_SCOPE(id)      ((void) 0)
+#define PROF_RESET()        ((void) 0)
+#define PROF_REPORT(uart_p) ((void) 0)
+
+#endif  // PROF_ENABLE
+
+#endif  // _PROF_H_INCLUDED
@@ -0,0 +1,81 @@
+/*****************************************************************//**
+ * @file sys_clock.h
+ *
+ * @brief std::chrono clock on the system timer count
+ *
+ * Description:
+ * - one sys_clock::duration tick is one system clock cycle
+ *   (1/SYS_CLK_FREQ us); a time_point is the count of the system
+ *   timer (now_tick())
+ * - chrono durations convert to ticks with a multiply, folded at
+ *   compile time for constants; e.g.,
+ *     deadline = sys_clock::now() + std::chrono::milliseconds(5);
+ *     while (sys_clock::now() < deadline) ...
+ * - ticks convert to us/ms only through an explicit duration_cast
+ *   (a 64-bit divide); keep deadlines and intervals in ticks
+ * - header only; <chrono> durations need no library code
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _SYS_CLOCK_H_INCLUDED
+#define _SYS_CLOCK_H_INCLUDED
+
+#include <chrono>
+#include "chu_init.h"
+
+/**
+ * system timer clock (std::chrono Clock requirements)
+ *
+ */
+struct sys_clock {
+   typedef uint64_t rep;
+   typedef std::ratio<1, SYS_CLK_FREQ * 1000000LL> period;
+   typedef std::chrono::duration<rep, period> duration;
+   typedef std::chrono::time_point<sys_clock> time_point;
+   static constexpr bool is_steady = true;
+
+   /**
+    * current system timer count
+    *
+    */
+   static time_point now() {
+      return (time_point(duration(now_tick())));
+   }
+};
+
+/**
+ * # system clock cycles of a duration
+ *
+ * @param d duration (e.g., std::chrono::microseconds(10))
+ *
+ * @note multiply only; a constant argument gives a constant
+ */
+template<class Rep, class Period>
+constexpr uint64_t to_ticks(const std::chrono::duration<Rep, Period> &d) {
+   return (std::chrono::duration_cast<sys_clock::duration>(d).count());
+}
+
+/**
+ * idle (busy waiting) until a time point
+ *
+ * @param t time point on sys_clock
+ *
+ * @note waits for the system timer alarm (see TimerCore::sleep())
+ */
+inline void sleep_until(sys_clock::time_point t) {
+   sleep_until_tick(t.time_since_epoch().count());
+}
+
+/**
+ * idle (busy waiting) for a duration
+ *
+ * @param d duration (e.g., std::chrono::milliseconds(2))
+ *
+ */
+template<class Rep, class Period>
+inline void sleep_for(const std::chrono::duration<Rep, Period> &d) {
+   sleep_until(sys_clock::now() + d);
+}
+
+#endif  // _SYS_CLOCK_H_INCLUDED
@@ -0,0 +1,24 @@
+/*****************************************************************//**
+ * @file telemetry.cpp
+ *
+ * @brief send binary telemetry frames
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "telemetry.h"
+#include "uart_core.h"
+
+void tlm_send(UartCore *uart_p, uint32_t tick, uint16_t raw, uint8_t status) {
+   static uint16_t seq = 0;
+   uint8_t frame[TLM_FRAME_LEN];
+
+   // whole frame or nothing; a dropped frame shows as a sequence gap
+   if (UartCore::TX_BUF_LEN - uart_p->tx_poll() < TLM_FRAME_LEN) {
+      seq++;
+      return;
+   }
+   tlm_pack(frame, seq, tick, raw, status);
+   seq++;
+   uart_p->write(frame, TLM_FRAME_LEN);
+}
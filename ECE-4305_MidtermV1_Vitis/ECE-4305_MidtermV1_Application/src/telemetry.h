@@ -0,0 +1,100 @@
+/*****************************************************************//**
+ * @file telemetry.h
+ *
+ * @brief binary telemetry record of ToF samples
+ *
+ * Description:
+ * - one fixed-size frame per sample, little endian:
+ *     bytes 0-1:   sync word 0xA5 0x5A
+ *     bytes 2-3:   sequence number (wraps)
+ *     bytes 4-7:   time stamp (32 LSBs of system clock count)
+ *     bytes 8-9:   raw distance (0xd1/0xd2)
+ *     byte  10:    status (see TLM_* flags)
+ *     bytes 11-12: CRC-16/CCITT-FALSE over bytes 2-10
+ * - header has no target dependency; the host decoder includes it
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _TELEMETRY_H_INCLUDED
+#define _TELEMETRY_H_INCLUDED
+
+#include <stdint.h>
+
+#define TLM_SYNC0       0xA5
+#define TLM_SYNC1       0x5A
+#define TLM_FRAME_LEN   13
+
+/* status flags */
+#define TLM_NACK        0x01   // device ack failed
+#define TLM_TIMEOUT     0x02   // data-ready irq timed out
+#define TLM_OVERFLOW    0x04   // sample(s) lost before this one
+#define TLM_SENSOR(id)  (((id) & 0x0f) << 4)  // sensor id in bits 7-4
+
+/**
+ * CRC-16/CCITT-FALSE (poly 0x1021, init 0xffff), bitwise
+ *
+ * @param data pointer to data bytes
+ * @param len number of bytes
+ * @return crc
+ */
+static inline uint16_t tlm_crc16(const uint8_t *data, int len) {
+   uint16_t crc = 0xffff;
+   int i, b;
+
+   for (i = 0; i < len; i++) {
+      crc = crc ^ ((uint16_t) data[i] << 8);
+      for (b = 0; b < 8; b++)
+         crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021) : (uint16_t) (crc << 1);
+   }
+   return crc;
+}
+
+/**
+ * build one frame
+ *
+ * @param frame pointer to TLM_FRAME_LEN-byte buffer
+ * @param seq sequence number
+ * @param tick time stamp
+ * @param raw raw distance
+ * @param status status flags
+ */
+static inline void tlm_pack(uint8_t *frame, uint16_t seq, uint32_t tick,
+      uint16_t raw, uint8_t status) {
+   uint16_t crc;
+
+   frame[0] = TLM_SYNC0;
+   frame[1] = TLM_SYNC1;
+   frame[2] = (uint8_t) seq;
+   frame[3] = (uint8_t) (seq >> 8);
+   frame[4] = (uint8_t) tick;
+   frame[5] = (uint8_t) (tick >> 8);
+   frame[6] = (uint8_t) (tick >> 16);
+   frame[7] = (uint8_t) (tick >> 24);
+   frame[8] = (uint8_t) raw;
+   frame[9] = (uint8_t) (raw >> 8);
+   frame[10] = status;
+   crc = tlm_crc16(&frame[2], 9);
+   frame[11] = (uint8_t) crc;
+   frame[12] = (uint8_t) (crc >> 8);
+}
+
+#ifdef __cplusplus
+class UartCore;
+
+/**
+ * send one frame over a uart
+ *
+ * @param uart_p pointer to uart core
+ * @param tick time stamp
+ * @param raw raw distance
+ * @param status status flags
+ *
+ * @note sequence number kept internally
+ * @note frame is queued in the uart tx ring (non-blocking); it is
+ *       dropped as a whole if the ring has no room
+ */
+void tlm_send(UartCore *uart_p, uint32_t tick, uint16_t raw, uint8_t status);
+#endif
+
+#endif  // _TELEMETRY_H_INCLUDED
@@ -12,6 +12,7 @@
 TimerCore::TimerCore(uint32_t core_base_addr) {
    base_addr = core_base_addr;
    ctrl = 0x01;
+   alarm_used = 0;
    clear();
    io_write(base_addr, CTRL_REG, ctrl);  // enable the timer
 }
@@ -48,17 +49,80 @@ uint64_t TimerCore::read_tick() {
    return ((upper << 32) | lower);
 }
 
+void TimerCore::set_capture(int src) {
+   io_write(base_addr, CAP_SRC_REG, (uint32_t) src);
+}
+
+uint32_t TimerCore::read_capture(uint64_t *tick) {
+   uint64_t upper, lower;
+
+   lower = (uint64_t) io_read(base_addr, CAP_LOWER_REG);
+   upper = (uint64_t) io_read(base_addr, CAP_UPPER_REG);
+   io_write(base_addr, CAP_CLR_REG, 0);
+   *tick = ((upper & 0x0000ffff) << 32) | lower;
+   return ((uint32_t) upper & (CAP_VALID_FIELD | CAP_OVF_FIELD));
+}
+
+uint32_t TimerCore::read_capture_lower() {
+   return (io_read(base_addr, CAP_LOWER_REG));
+}
+
 uint64_t TimerCore::read_time() {
    // elapsed time in microsecond (SYS_CLK_FREQ in MHz)
    return (read_tick() / SYS_CLK_FREQ);
 }
 
-void TimerCore::sleep(uint64_t us) {
-   uint64_t start_time, now;
+void TimerCore::write_alarm(uint64_t tick, uint32_t period, uint32_t alarm) {
+   // compare value and period are written before the alarm is armed
+   io_write(base_addr, CMP_LOWER_REG, (uint32_t) tick);
+   io_write(base_addr, CMP_UPPER_REG, (uint32_t) (tick >> 32));
+   io_write(base_addr, PERIOD_REG, period);
+   io_write(base_addr, ALARM_REG, alarm);
+}
+
+void TimerCore::set_alarm(uint64_t tick, uint32_t period, int irq) {
+   alarm_used = 1;
+   io_write(base_addr, ALARM_REG, 0);    // disarm during update
+   write_alarm(tick, period, ARM_FIELD | (irq ? IRQ_EN_FIELD : 0));
+}
+
+void TimerCore::cancel_alarm() {
+   alarm_used = 0;
+   io_write(base_addr, ALARM_REG, 0);
+}
+
+uint32_t TimerCore::alarm_status() {
+   return (io_read(base_addr, ALARM_REG));
+}
+
+void TimerCore::ack_alarm() {
+   io_write(base_addr, ALARM_ACK_REG, 0);
+}
+
+int TimerCore::wait_alarm() {
+   uint32_t status;
 
-   start_time = read_time();
-   // busy waiting
    do {
-      now = read_time();
-   } while ((now - start_time) < us);
+      status = io_read(base_addr, ALARM_REG);
+   } while (!(status & EVENT_FIELD));
+   ack_alarm();
+   return ((status & MISS_FIELD) ? 1 : 0);
+}
+
+void TimerCore::sleep(uint64_t us) {
+   sleep_until(read_tick() + us * SYS_CLK_FREQ);
+}
+
+void TimerCore::sleep_until(uint64_t end) {
+   if (alarm_used) {
+      // alarm in use; busy waiting on the counter
+      while (read_tick() < end) {
+      }
+      return;
+   }
+   // one-shot alarm, irq output off
+   write_alarm(end, 0, ARM_FIELD);
+   while (!(io_read(base_addr, ALARM_REG) & EVENT_FIELD)) {
+   }
+   io_write(base_addr, ALARM_REG, 0);
 }
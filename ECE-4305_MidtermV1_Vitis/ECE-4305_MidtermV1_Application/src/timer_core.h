@@ -16,6 +16,8 @@
 /**
  * timer core driver:
  *  - control and retrieve clock count from MMIO timer core.
+ *  - one-shot/periodic alarm on a compare value; its irq output is
+ *    MCS external interrupt 1 (IntcCore::EXT_INTR_BASE + 1)
  *
  */
 class TimerCore {
@@ -25,9 +27,18 @@ public:
     *
     */
    enum {
-      COUNTER_LOWER_REG = 0, /**< lower 32 bits of counter */
-      COUNTER_UPPER_REG = 1, /**< upper 16 bits of counter */
-      CTRL_REG = 2           /**< control register */
+      COUNTER_LOWER_REG = 0, /**< lower 32 bits of counter (latches upper) */
+      COUNTER_UPPER_REG = 1, /**< upper 16 bits latched by lower read */
+      CTRL_REG = 2,          /**< control register */
+      CMP_LOWER_REG = 3,     /**< lower 32 bits of compare value */
+      CMP_UPPER_REG = 4,     /**< upper 16 bits of compare value */
+      PERIOD_REG = 5,        /**< alarm period in clocks (0: one-shot) */
+      ALARM_REG = 6,         /**< alarm control (write)/status (read) */
+      ALARM_ACK_REG = 7,     /**< dummy write clears event and miss */
+      CAP_LOWER_REG = 8,     /**< lower 32 bits of capture (read; latches upper) */
+      CAP_UPPER_REG = 9,     /**< upper 16 bits of capture and flags (read) */
+      CAP_SRC_REG = 8,       /**< capture source (write) */
+      CAP_CLR_REG = 9        /**< dummy write clears valid and overrun */
    };
    /**
    * field masks
@@ -35,7 +46,22 @@ public:
    */
    enum {
       GO_FIELD = 0x00000001, /**< bit 0 of ctrl_reg; enable bit  */
-      CLR_FIELD = 0x00000002 /**< bit 1 of ctrl_reg; clear bit */
+      CLR_FIELD = 0x00000002, /**< bit 1 of ctrl_reg; clear bit */
+      ARM_FIELD = 0x00000001, /**< bit 0 of alarm_reg; armed */
+      IRQ_EN_FIELD = 0x00000002, /**< bit 1 of alarm_reg; irq output enable */
+      EVENT_FIELD = 0x00000004, /**< bit 2 of alarm_reg (read); alarm event */
+      MISS_FIELD = 0x00000008, /**< bit 3 of alarm_reg (read); event missed */
+      CAP_VALID_FIELD = 0x00010000, /**< bit 16 of cap_upper_reg; new capture */
+      CAP_OVF_FIELD = 0x00020000  /**< bit 17 of cap_upper_reg; capture lost */
+   };
+   /**
+    * capture event sources
+    *
+    */
+   enum {
+      CAP_OFF = 0,           /**< capture disabled */
+      CAP_TOF_IRQ = 1,       /**< ToF data-ready irq asserted */
+      CAP_ACQ_START = 2      /**< sample start of acquisition engine (slot 14) */
    };
    /* methods */
    /**
@@ -69,6 +95,8 @@ public:
    /**
     * read current timing counter value (# clocks elapsed from last clear)
     *
+    * @note the upper bits are latched by the lower read; no tearing
+    *       across a 32-bit rollover
     */
    uint64_t read_tick();
 
@@ -80,18 +108,99 @@ public:
     */
    uint64_t read_time();
 
+   /**
+    * arm the alarm
+    *
+    * @param tick counter value of the (first) event
+    * @param period # clocks between events; 0: one-shot
+    * @param irq 1: drive the irq output (MCS INTC_Interrupt[1])
+    *
+    * @note a tick already passed fires at once
+    * @note the event is latched until ack_alarm() or the next set_alarm()
+    *
+    */
+   void set_alarm(uint64_t tick, uint32_t period, int irq);
+
+   /**
+    * disarm the alarm and clear its event (alarm free for sleep())
+    *
+    */
+   void cancel_alarm();
+
+   /**
+    * read alarm status (ARM/IRQ_EN/EVENT/MISS fields)
+    *
+    */
+   uint32_t alarm_status();
+
+   /**
+    * clear alarm event (and irq output)
+    *
+    */
+   void ack_alarm();
+
+   /**
+    * wait for the alarm event and clear it
+    *
+    * @return 1: event(s) missed (periodic alarm not serviced in time);
+    *         0: otherwise
+    *
+    */
+   int wait_alarm();
+
+   /**
+    * select the event that captures the counter
+    *
+    * @param src CAP_OFF, CAP_TOF_IRQ or CAP_ACQ_START
+    *
+    * @note valid and overrun flags are cleared
+    * @note a ToF irq is synchronized first; its capture is 3 clocks late
+    */
+   void set_capture(int src);
+
+   /**
+    * read the last captured counter value and clear its flags
+    *
+    * @param tick pointer to captured counter value
+    * @return CAP_VALID_FIELD (captured since last call) and
+    *         CAP_OVF_FIELD (a capture was overwritten) bits
+    *
+    */
+   uint32_t read_capture(uint64_t *tick);
+
+   /**
+    * read 32 LSBs of the last captured counter value
+    *
+    * @note one bus read; flags are not changed
+    */
+   uint32_t read_capture_lower();
+
    /**
     * idle (busy waiting) for us microsecond
     *
     * @param us idle time in micro second
     * @note will block the program execution
+    * @note waits for a one-shot alarm: one status read per poll and no
+    *       division; the counter is polled instead while an alarm of
+    *       set_alarm() is in use
     *
     */
    void sleep(uint64_t us);
 
+   /**
+    * idle (busy waiting) until the counter reaches a value
+    *
+    * @param tick counter value
+    * @note same waiting as sleep(); a passed value returns at once
+    *
+    */
+   void sleep_until(uint64_t tick);
+
 private:
    uint32_t base_addr;
    uint32_t ctrl;    // current state of control register
+   int alarm_used;   // alarm taken by set_alarm()
+   void write_alarm(uint64_t tick, uint32_t period, uint32_t alarm);
 };
 
 #endif  // _TIMER_H_INCLUDED
@@ -0,0 +1,76 @@
+/*****************************************************************//**
+ * @file tof_acq_core.cpp
+ *
+ * @brief implementation of TofAcqCore class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "tof_acq_core.h"
+
+TofAcqCore::TofAcqCore(uint32_t core_base_addr) {
+   base_addr = core_base_addr;
+   ctrl = 0;
+   io_write(base_addr, CTRL_REG, ctrl);
+}
+
+TofAcqCore::~TofAcqCore() {
+}
+
+void TofAcqCore::set_dev(uint8_t dev) {
+   io_write(base_addr, DEV_REG, dev);
+}
+
+void TofAcqCore::set_period(uint32_t us) {
+   io_write(base_addr, PERIOD_REG, us * SYS_CLK_FREQ);
+}
+
+void TofAcqCore::set_conv_wait(uint32_t us) {
+   io_write(base_addr, CONV_REG, us * SYS_CLK_FREQ);
+}
+
+void TofAcqCore::enable() {
+   ctrl = ctrl | EN_FIELD;
+   io_write(base_addr, CTRL_REG, ctrl);
+}
+
+void TofAcqCore::disable() {
+   ctrl = ctrl & ~EN_FIELD;
+   io_write(base_addr, CTRL_REG, ctrl);
+   while (status() & BUSY_FIELD) {
+   }
+}
+
+uint32_t TofAcqCore::status() {
+   return (io_read(base_addr, CTRL_REG));
+}
+
+int TofAcqCore::count() {
+   return ((int) (status() >> 8) & 0xff);
+}
+
+int TofAcqCore::overflow() {
+   if (status() & OVF_FIELD) {
+      io_write(base_addr, CTRL_REG, ctrl | CLR_OVF_FIELD);
+      return (1);
+   }
+   return (0);
+}
+
+int TofAcqCore::read_samples(tof_sample_t *samples, int max) {
+   uint32_t data;
+   int n, i;
+
+   n = count();
+   if (n > max)
+      n = max;
+   for (i = 0; i < n; i++) {
+      samples->tick = io_read(base_addr, PERIOD_REG);
+      data = io_read(base_addr, CONV_REG);
+      io_write(base_addr, RM_SAMPLE_REG, 0); //dummy write to remove sample
+      samples->raw = (uint16_t) (data & 0xffff);
+      samples->nack = (data & NACK_FIELD) ? 1 : 0;
+      samples++;
+   }
+   return (n);
+}
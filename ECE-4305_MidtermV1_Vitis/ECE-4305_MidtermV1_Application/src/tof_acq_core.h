@@ -0,0 +1,149 @@
+/*****************************************************************//**
+ * @file tof_acq_core.h
+ *
+ * @brief access MMIO ToF acquisition engine core
+ *
+ * Description:
+ * - the core issues the ISL29501 sample-start and result reads
+ *   by itself at a programmable period
+ * - time-stamped raw distances are pushed into a sample FIFO
+ * - the core drives the i2c master of the ToF i2c slot;
+ *   the i2c slot must not be used by software while the engine runs
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _TOF_ACQ_CORE_H_INCLUDED
+#define _TOF_ACQ_CORE_H_INCLUDED
+
+#include "chu_init.h"
+
+/**
+ * one sample retrieved from the acquisition engine
+ */
+typedef struct {
+   uint32_t tick;    /**< 32 LSBs of system timer at sample start */
+   uint16_t raw;     /**< raw distance (0xd1/0xd2) */
+   uint8_t nack;     /**< 1: a device ack failed during the sample */
+} tof_sample_t;
+
+/**
+ * ToF acquisition engine core driver
+ * - configure sample period / conversion wait / device address
+ * - drain time-stamped samples from the sample FIFO in bursts
+ *
+ */
+class TofAcqCore {
+public:
+   /**
+    * register map
+    *
+    */
+   enum {
+      CTRL_REG = 0,     /**< control (write) / status (read) register */
+      PERIOD_REG = 1,   /**< sample period (write) / head time stamp (read) */
+      CONV_REG = 2,     /**< conversion wait (write) / head sample (read) */
+      RM_SAMPLE_REG = 3,/**< dummy write to remove head sample */
+      DEV_REG = 4       /**< device address register */
+   };
+   /**
+    * field masks
+    *
+    */
+   enum {
+      EN_FIELD = 0x00000001,      /**< bit 0 of ctrl_reg; enable */
+      CLR_OVF_FIELD = 0x00000002, /**< bit 1 of ctrl_reg; clear overflow */
+      BUSY_FIELD = 0x00000001,    /**< bit 0 of status; engine owns i2c */
+      EMPTY_FIELD = 0x00000002,   /**< bit 1 of status; FIFO empty */
+      FULL_FIELD = 0x00000004,    /**< bit 2 of status; FIFO full */
+      OVF_FIELD = 0x00000008,     /**< bit 3 of status; sample lost */
+      NACK_FIELD = 0x00010000     /**< bit 16 of sample; ack failed */
+   };
+   /* methods */
+   /**
+    * constructor
+    *
+    * @note engine disabled; hardware defaults: 10 ms period, 5 ms wait
+    */
+   TofAcqCore(uint32_t core_base_addr);
+   ~TofAcqCore();                  // not used
+
+   /**
+    * set i2c device address of the sensor
+    *
+    * @param dev 7-bit device address
+    *
+    */
+   void set_dev(uint8_t dev);
+
+   /**
+    * set sample period
+    *
+    * @param us period between sample starts in microsecond
+    *
+    */
+   void set_period(uint32_t us);
+
+   /**
+    * set conversion wait
+    *
+    * @param us time from sample start to result read in microsecond
+    *
+    */
+   void set_conv_wait(uint32_t us);
+
+   /**
+    * start autonomous acquisition
+    *
+    * @note i2c slot must be idle
+    *
+    */
+   void enable();
+
+   /**
+    * stop autonomous acquisition
+    *
+    * @note returns after the sample in progress completes and
+    *       the i2c slot is released to software
+    *
+    */
+   void disable();
+
+   /**
+    * read status register
+    *
+    */
+   uint32_t status();
+
+   /**
+    * # samples in FIFO
+    *
+    */
+   int count();
+
+   /**
+    * check whether a sample was lost due to full FIFO (clears the flag)
+    *
+    * @return 1: sample(s) lost; 0: otherwise
+    *
+    */
+   int overflow();
+
+   /**
+    * drain samples from FIFO
+    *
+    * @param samples pointer to sample array
+    * @param max max # samples to be retrieved
+    * @return # samples retrieved
+    *
+    * @note FIFO count read once; samples then read back to back
+    *
+    */
+   int read_samples(tof_sample_t *samples, int max);
+
+private:
+   uint32_t base_addr;
+   uint32_t ctrl;    // current state of control register
+};
+
+#endif  // _TOF_ACQ_CORE_H_INCLUDED
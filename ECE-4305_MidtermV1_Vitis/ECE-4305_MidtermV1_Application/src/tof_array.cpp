@@ -0,0 +1,153 @@
+/*****************************************************************//**
+ * @file tof_array.cpp
+ *
+ * @brief implementation of TofArray class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "tof_array.h"
+#include "sys_clock.h"
+
+TofArray::TofArray() {
+   n_sensors = 0;
+   period = to_ticks(std::chrono::milliseconds(10));
+   conv_wait = to_ticks(std::chrono::milliseconds(5));
+}
+
+TofArray::~TofArray() {
+}
+
+int TofArray::add(I2cCore *bus, uint8_t dev) {
+   sensor_t *s;
+
+   if (n_sensors == MAX_SENSORS)
+      return (-1);
+   s = &sensors[n_sensors];
+   s->bus = bus;
+   s->dev = dev;
+   s->state = S_IDLE;
+   s->head = 0;
+   s->tail = 0;
+   s->ovf = 0;
+   n_sensors++;
+   return (n_sensors - 1);
+}
+
+void TofArray::set_period(uint32_t us) {
+   period = to_ticks(std::chrono::microseconds(us));
+}
+
+void TofArray::set_conv_wait(uint32_t us) {
+   conv_wait = to_ticks(std::chrono::microseconds(us));
+}
+
+void TofArray::start() {
+   uint32_t now;
+   int i;
+
+   now = (uint32_t) now_tick();
+   for (i = 0; i < n_sensors; i++) {
+      sensors[i].t_next = now + i * (period / n_sensors);
+      sensors[i].state = S_WAIT;
+   }
+}
+
+/* submit a transaction of a sensor on its bus */
+void TofArray::submit(sensor_t *s, uint8_t *wbytes, int wnum, int rnum) {
+   s->xfer.dev = s->dev;
+   s->xfer.wbytes = wbytes;
+   s->xfer.wnum = wnum;
+   s->xfer.rbytes = s->rbytes;
+   s->xfer.rnum = rnum;
+   s->xfer.rstart = 0;
+   s->xfer.done = 0;
+   s->xfer.arg = 0;
+   s->bus->submit(&s->xfer);
+}
+
+/* sample start -> timed conversion -> result read -> ring buffer */
+void TofArray::step(sensor_t *s, uint32_t now) {
+   tof_sample_t *p;
+
+   switch (s->state) {
+   case S_WAIT:
+      if ((int32_t) (now - s->t_next) >= 0 && !s->bus->busy()) {
+         s->t_next = s->t_next + period;
+         if ((int32_t) (now - s->t_next) >= 0)
+            s->t_next = now + period;   // fell behind; skip missed slots
+         s->wbytes[0] = 0xB0;           // command register
+         s->wbytes[1] = 0x49;           // sample start
+         submit(s, s->wbytes, 2, 0);
+         s->state = S_START;
+      }
+      break;
+   case S_START:
+      if (s->xfer.status != I2cCore::I2C_XFER_PENDING) {
+         s->nack = (s->xfer.status != 0);
+         s->tick = now;                 // 32 LSBs of clock count
+         s->t_ready = now + conv_wait;
+         s->state = S_CONV;
+      }
+      break;
+   case S_CONV:
+      if ((int32_t) (now - s->t_ready) >= 0 && !s->bus->busy()) {
+         s->wbytes[0] = 0xD1;           // distance msb; lsb follows
+         submit(s, s->wbytes, 1, 2);
+         s->state = S_READ;
+      }
+      break;
+   case S_READ:
+      if (s->xfer.status != I2cCore::I2C_XFER_PENDING) {
+         if (((s->head + 1) % STREAM_LEN) == s->tail) {
+            s->ovf = 1;                 // stream full; drop sample
+         } else {
+            p = &s->ring[s->head];
+            p->tick = s->tick;
+            p->raw = (uint16_t) ((s->rbytes[0] << 8) | s->rbytes[1]);
+            p->nack = s->nack || (s->xfer.status != 0);
+            s->head = (s->head + 1) % STREAM_LEN;
+         }
+         s->state = S_WAIT;
+      }
+      break;
+   default:    // S_IDLE
+      break;
+   }
+}
+
+void TofArray::poll() {
+   uint32_t now;
+   int i;
+
+   for (i = 0; i < n_sensors; i++)
+      sensors[i].bus->poll();
+   now = (uint32_t) now_tick();
+   for (i = 0; i < n_sensors; i++)
+      step(&sensors[i], now);
+}
+
+int TofArray::available(int id) {
+   sensor_t *s = &sensors[id];
+
+   return ((s->head - s->tail + STREAM_LEN) % STREAM_LEN);
+}
+
+int TofArray::read(int id, tof_sample_t *samples, int max) {
+   sensor_t *s = &sensors[id];
+   int n = 0;
+
+   while (n < max && s->tail != s->head) {
+      samples[n] = s->ring[s->tail];
+      s->tail = (s->tail + 1) % STREAM_LEN;
+      n++;
+   }
+   return (n);
+}
+
+int TofArray::overflow(int id) {
+   int ovf = sensors[id].ovf;
+
+   sensors[id].ovf = 0;
+   return (ovf);
+}
@@ -0,0 +1,150 @@
+/*****************************************************************//**
+ * @file tof_array.h
+ *
+ * @brief interleaved acquisition of several ISL29501 sensors
+ *
+ * Description:
+ * - sensors may sit on any i2c core (e.g., slots 4 and 10)
+ * - each sensor runs in single-shot mode at a common sample period;
+ *   start times are staggered across the period
+ * - all bus traffic uses the non-blocking I2cCore::submit()/poll();
+ *   one sensor is read out while others are converting
+ * - time-stamped raw distances are kept in a ring buffer per sensor
+ * - conversion end is timed (no per-sensor irq line)
+ * - all times are kept in system clock cycles (32 LSBs of now_tick())
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _TOF_ARRAY_H_INCLUDED
+#define _TOF_ARRAY_H_INCLUDED
+
+#include "i2c_core.h"
+#include "tof_acq_core.h"   // tof_sample_t
+
+/**
+ * ToF sensor array driver
+ * - register sensors, start acquisition, poll from the main loop
+ * - drain per-sensor sample streams
+ *
+ */
+class TofArray {
+public:
+   /**
+    * size constants
+    *
+    */
+   enum {
+      MAX_SENSORS = 4,   /**< max # sensors */
+      STREAM_LEN = 16    /**< # samples buffered per sensor */
+   };
+   /* methods */
+   /**
+    * constructor
+    *
+    * @note defaults: 10 ms period, 5 ms conversion wait
+    */
+   TofArray();
+   ~TofArray();                  // not used
+
+   /**
+    * add a sensor
+    *
+    * @param bus pointer to the i2c core of the sensor
+    * @param dev 7-bit device address
+    * @return sensor id; -1 if the array is full
+    *
+    * @note the sensor must be initialized (single-shot mode)
+    *
+    */
+   int add(I2cCore *bus, uint8_t dev);
+
+   /**
+    * set per-sensor sample period
+    *
+    * @param us period in microsecond
+    *
+    */
+   void set_period(uint32_t us);
+
+   /**
+    * set conversion wait (sample start to result read)
+    *
+    * @param us wait time in microsecond
+    *
+    */
+   void set_conv_wait(uint32_t us);
+
+   /**
+    * start acquisition; sensor i starts at i*period/n
+    *
+    */
+   void start();
+
+   /**
+    * advance all sensors and buses (never waits)
+    *
+    * @note call as often as possible from the main loop
+    *
+    */
+   void poll();
+
+   /**
+    * # samples buffered for a sensor
+    *
+    * @param id sensor id
+    *
+    */
+   int available(int id);
+
+   /**
+    * retrieve samples of a sensor
+    *
+    * @param id sensor id
+    * @param samples pointer to sample array
+    * @param max max # samples to be retrieved
+    * @return # samples retrieved
+    *
+    * @note tick is the 32 LSBs of the system clock count
+    *       at the end of the sample start
+    *
+    */
+   int read(int id, tof_sample_t *samples, int max);
+
+   /**
+    * check whether samples of a sensor were lost (clears the flag)
+    *
+    * @param id sensor id
+    * @return 1: sample(s) lost; 0: otherwise
+    *
+    */
+   int overflow(int id);
+
+private:
+   /* per-sensor state */
+   enum { S_IDLE, S_WAIT, S_START, S_CONV, S_READ };
+   typedef struct {
+      I2cCore *bus;
+      uint8_t dev;
+      int state;
+      uint32_t t_next;      // next sample start (clk)
+      uint32_t t_ready;     // conversion end (clk)
+      uint32_t tick;        // time stamp of current sample
+      int nack;             // ack failed in current sample
+      uint8_t wbytes[2];
+      uint8_t rbytes[2];
+      i2c_xfer_t xfer;
+      tof_sample_t ring[STREAM_LEN];
+      int head, tail;       // ring indices (head: write, tail: read)
+      int ovf;
+   } sensor_t;
+   sensor_t sensors[MAX_SENSORS];
+   int n_sensors;
+   uint32_t period;      // clk
+   uint32_t conv_wait;   // clk
+   /* methods */
+   void step(sensor_t *s, uint32_t now);
+   void submit(sensor_t *s, uint8_t *wbytes, int wnum, int rnum);
+};
+
+#endif  // _TOF_ARRAY_H_INCLUDED
@@ -8,21 +8,34 @@
  ********************************************************************/
 
 #include "uart_core.h"
+#include "num_fmt.h"
 
 UartCore::UartCore(uint32_t core_base_addr) {
    base_addr = core_base_addr;
+   tx_head = 0;
+   tx_tail = 0;
+   tx_drops = 0;
+   tx_policy = TX_DROP_NEWEST;
    set_baud_rate(9600);      //default baud rate
 }
 
 UartCore::~UartCore() {
 }
 
-/* baud rate = sys_clk_freq/16/(dvsr+1) */
+/* baud rate = sys_clk_freq/16 * inc/2^24 */
 void UartCore::set_baud_rate(int baud) {
-   uint32_t dvsr;
+   uint64_t clk = (uint64_t) SYS_CLK_FREQ * 1000000;
+   uint64_t inc;
+
+   inc = (((uint64_t) baud * 16 << BAUD_ACC_BITS) + clk / 2) / clk;
+   if (inc >= (1UL << BAUD_ACC_BITS))
+      inc = (1UL << BAUD_ACC_BITS) - 1;   // tick on every clock but one
+   io_write(base_addr, BAUD_INC_REG, (uint32_t) inc);
+   baud_rate = baud;
+}
 
-   dvsr = SYS_CLK_FREQ*1000000 / 16 / baud - 1;
-   io_write(base_addr, DVSR_REG, dvsr);
+int UartCore::get_baud_rate() {
+   return (baud_rate);
 }
 
 int UartCore::rx_fifo_empty() {
@@ -43,12 +56,92 @@ int UartCore::tx_fifo_full() {
    return (full);
 }
 
+int UartCore::tx_fifo_free() {
+   uint32_t rd_word;
+
+   rd_word = io_read(base_addr, RD_DATA_REG);
+   return ((int) ((rd_word & TX_FREE_FIELD) >> 16));
+}
+
 void UartCore::tx_byte(uint8_t byte) {
+   tx_flush();  // keep queued bytes in order
    while (tx_fifo_full()) {
    };  // busy waiting
    io_write(base_addr, WR_DATA_REG, (uint32_t )byte);
 }
 
+int UartCore::tx_put(uint8_t byte) {
+   tx_poll();
+   return (queue(byte));
+}
+
+/* put a byte into the ring; no tx fifo access */
+int UartCore::queue(uint8_t byte) {
+   int rc = 0;
+
+   if (tx_head - tx_tail >= TX_BUF_LEN) {
+      tx_drops++;
+      if (tx_policy == TX_DROP_NEWEST)
+         return (-1);
+      tx_tail++;  // overwrite oldest byte
+      rc = -1;
+   }
+   tx_buf[tx_head & (TX_BUF_LEN - 1)] = byte;
+   tx_head++;
+   return (rc);
+}
+
+int UartCore::write(const uint8_t *data, size_t num) {
+   size_t i = 0;
+   int free, n = 0;
+
+   // nothing queued: straight into the tx fifo
+   if (tx_poll() == 0) {
+      free = tx_fifo_free();
+      while (i < num && free > 0) {
+         io_write(base_addr, WR_DATA_REG, (uint32_t) data[i]);
+         i++;
+         free--;
+         n++;
+      }
+   }
+   for (; i < num; i++)
+      if (queue(data[i]) == 0 || tx_policy == TX_DROP_OLDEST)
+         n++;
+   return (n);
+}
+
+int UartCore::tx_poll() {
+   int free;
+
+   if (tx_head == tx_tail)
+      return (0);
+   free = tx_fifo_free();
+   while (tx_head != tx_tail && free > 0) {
+      io_write(base_addr, WR_DATA_REG, (uint32_t) tx_buf[tx_tail & (TX_BUF_LEN - 1)]);
+      tx_tail++;
+      free--;
+   }
+   return ((int) (tx_head - tx_tail));
+}
+
+int UartCore::tx_pending() {
+   return ((int) (tx_head - tx_tail));
+}
+
+uint32_t UartCore::tx_overflow() {
+   return (tx_drops);
+}
+
+void UartCore::set_tx_policy(int policy) {
+   tx_policy = policy;
+}
+
+void UartCore::tx_flush() {
+   while (tx_poll()) {
+   };  // busy waiting
+}
+
 int UartCore::rx_byte() {
    uint32_t data;
 
@@ -66,56 +159,13 @@ void UartCore::disp(const char *str) {
 }
 
 void UartCore::disp(char ch) {
-    tx_byte(ch);
+    tx_put(ch);
 }
 
 void UartCore::disp(int n, int base, int len) {
-   char buf[33];         // 32 bit #
-   char *str, ch, sign;
-   int rem, i;
-   unsigned int un;
-
-   /* error check */
-   if (base != 2 && base != 8 && base != 16)
-      base = 10;
-   if (len > 32)
-      len = 32;
-   /* handle neg decimal # */
-   if (base == 10 && n < 0) {
-      un = (unsigned) -n;
-      sign = '-';
-   } else {
-      un = (unsigned) n; // interpreted as unsigned for hex/bin conversion
-      sign = ' ';
-   }
-   /* convert # to string */
-   str = &buf[33];
-   *str = '\0';
-   i = 0;
-   do {
-      str--;
-      rem = un % base;
-      un = un / base;
-      if (rem < 10)
-         ch = (char) rem + '0';
-      else
-         ch = (char) rem - 10 + 'a';
-      *str = ch;
-      i++;
-   } while (un);
-   /* attach - sign for neg decimal # */
-   if (sign == '-') {
-      str--;
-      *str = sign;
-      i++;
-   }
-   /* pad with blank */
-   while (i < len) {
-      str--;
-      *str = ' ';
-      i++;
-   };
-   disp_str(str);
+   char buf[FMT_BUF_LEN];
+
+   write((const uint8_t *) buf, fmt_int(buf, n, base, len));
 }
 
 void UartCore::disp(int n) {
@@ -127,37 +177,49 @@ void UartCore::disp(int n, int base) {
 }
 
 void UartCore::disp(double f, int digit) {
+   char buf[FMT_BUF_LEN + 24];
    double fa, frac; // absolute value of f
-   int n, i, i_part;
+   int n, i, k = 0;
+   uint32_t i_part;
 
+   if (digit > 24)
+      digit = 24;
    fa = f;
    if (f < 0.0) {
       fa = -f;
-      disp_str("-");
+      buf[k++] = '-';
    }
-   // display integer portion
-   i_part = (int) fa; // integer part of f
-   disp(i_part);
-   disp_str(".");
-   // display fraction part
+   // integer portion
+   i_part = (uint32_t) fa; // integer part of f
+   k += fmt_udec(buf + k, i_part, 1);
+   buf[k++] = '.';
+   // fraction part
    frac = fa - (double) i_part;
    for (n = 0; n < digit; n++) {
       frac = frac * 10.0;
       i = (int) frac;
-      disp(i);
+      buf[k++] = (char) i + '0';
       frac = frac - i;
    }
+   write((const uint8_t *) buf, k);
 }
 
 void UartCore::disp(double f) {
    disp(f, 3);
 }
 
+void UartCore::disp_fixed(int n, int frac) {
+   char buf[FMT_BUF_LEN];
+
+   write((const uint8_t *) buf, fmt_fixed(buf, n, frac));
+}
+
 void UartCore::disp_str(const char *str) {
-   while ((uint8_t) *str) {
-      tx_byte(*str);
-      str++;
-   }
+   size_t len = 0;
+
+   while ((uint8_t) str[len])
+      len++;
+   write((const uint8_t *) str, len);
 }
 
 
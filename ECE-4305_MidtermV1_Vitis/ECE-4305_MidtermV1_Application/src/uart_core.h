@@ -13,10 +13,15 @@
 
 #include "chu_io_rw.h"
 #include "chu_io_map.h"  // to use SYS_CLK_FREQ
+#include <stddef.h>      // size_t
 /**
  * uart core driver
  * - transmit/receive data via MMIO uart core.
  * - display (print) number and string on serial console
+ * - numbers are converted without division (num_fmt.h) and sent
+ *   with one bulk write
+ * - disp() output is queued in a software tx ring buffer and moved to
+ *   the core's tx FIFO by tx_poll(); it never waits on the serial link
  *
  */
 class UartCore {
@@ -26,7 +31,7 @@ class UartCore {
     */
    enum {
       RD_DATA_REG = 0,   /**< rx data/status register */
-      DVSR_REG = 1,      /**< baud rate divisor register */
+      BAUD_INC_REG = 1,  /**< baud rate increment register */
       WR_DATA_REG = 2,   /**< wr data register */
       RM_RD_DATA_REG = 3 /**< remove read data offset */
    };
@@ -37,9 +42,26 @@ class UartCore {
    enum {
       TX_FULL_FIELD = 0x00000200, /**< bit 9 of rd_data_reg; full bit  */
       RX_EMPT_FIELD = 0x00000100, /**< bit 10 of rd_data_reg; empty bit */
-      RX_DATA_FIELD = 0x000000ff  /**< bits 7..0 rd_data_reg; read data */
+      RX_DATA_FIELD = 0x000000ff, /**< bits 7..0 rd_data_reg; read data */
+      TX_FREE_FIELD = 0xffff0000  /**< bits 31..16 rd_data_reg; # free tx fifo entries */
+   };
+  /**
+   * baud rate generator
+   *
+   */
+   enum {
+      BAUD_ACC_BITS = 24          /**< width of phase accumulator */
    };
 public:
+  /**
+   * tx ring buffer
+   *
+   */
+   enum {
+      TX_BUF_LEN = 1024,          /**< # bytes of ring (power of 2) */
+      TX_DROP_NEWEST = 0,         /**< full ring: discard new byte */
+      TX_DROP_OLDEST = 1          /**< full ring: overwrite oldest byte */
+   };
    /* methods */
    /**
     * constructor.
@@ -52,11 +74,19 @@ public:
    /**
     * set baud rate
     *
-    * @param baud baud rate
-    * @note baud rate = sys_clk_freq/16/(dvsr+1)
+    * @param baud baud rate (up to sys_clk_freq/16)
+    * @note baud rate = sys_clk_freq/16 * inc/2^24; the rounded increment
+    *       keeps the error below 0.2 baud at 100 MHz
+    *       (e.g., 0.2 ppm at 921600, 0.1 ppm at 2M baud)
     */
    void set_baud_rate(int baud);
 
+   /**
+    * get baud rate set by set_baud_rate()
+    *
+    */
+   int get_baud_rate();
+
    /**
     * check whether uart receiver fifo is empty
     *
@@ -73,16 +103,83 @@ public:
     */
    int tx_fifo_full();
 
+   /**
+    * get # free entries of uart transmitter fifo
+    *
+    */
+   int tx_fifo_free();
+
    /**
     * transmit a byte
     *
     * @param byte data byte to be transmitted
     *
-    * @note the function "busy waits" if tx fifo is full;
-    *       to avoid "blocking" execution, use tx_fifo_full() to check status as needed
+    * @note the function "busy waits" until the tx ring is drained and the
+    *       tx fifo takes the byte;
+    *       to avoid "blocking" execution, use tx_put() instead
     */
    void tx_byte(uint8_t byte);
 
+   /**
+    * queue a byte in the tx ring buffer
+    *
+    * @param byte data byte to be transmitted
+    * @return 0: queued; -1: ring full (byte or oldest byte dropped)
+    *
+    * @note the function does not "busy wait"; drains the ring first
+    * @note drop is counted by tx_overflow(); policy set by set_tx_policy()
+    */
+   int tx_put(uint8_t byte);
+
+   /**
+    * transmit a block of bytes
+    *
+    * @param data pointer to data bytes
+    * @param num # bytes
+    * @return # bytes queued or sent (less than num if dropped)
+    *
+    * @note the function does not "busy wait"; with an empty ring, the tx
+    *       fifo free count is read once and that many bytes are written
+    *       back to back; the rest is queued in the ring
+    */
+   int write(const uint8_t *data, size_t num);
+
+   /**
+    * move queued bytes to the tx fifo until either is empty/full
+    *
+    * @return # bytes still queued in the ring
+    *
+    * @note poll hook; call from the main loop and busy-wait loops
+    * @note one status read per call (tx fifo free count)
+    */
+   int tx_poll();
+
+   /**
+    * # bytes queued in the tx ring buffer
+    *
+    */
+   int tx_pending();
+
+   /**
+    * # bytes dropped because the tx ring was full
+    *
+    */
+   uint32_t tx_overflow();
+
+   /**
+    * select the full-ring policy
+    *
+    * @param policy TX_DROP_NEWEST (default) or TX_DROP_OLDEST
+    *
+    */
+   void set_tx_policy(int policy);
+
+   /**
+    * wait until all queued bytes are in the tx fifo
+    *
+    */
+   void tx_flush();
+
    /**
     * receive a byte
     *
@@ -148,6 +245,7 @@ public:
     *
     * @param f floating-point number to be displayed
     * @param digit # of digits (length) in fraction portion to be displayed
+    *        (up to 24)
     * @note base 10 used
     * @note length in integer determined automatically
     *
@@ -165,9 +263,25 @@ public:
     */
    void disp(double f);
 
+   /**
+    * display (print) a fixed-point decimal number on a serial terminal console
+    *
+    * @param n value scaled by 10^frac (e.g., micrometers with frac=6 for meters)
+    * @param frac # of digits in fraction portion (0 to 9)
+    * @note integer arithmetic only (no floating-point library)
+    *
+    */
+   void disp_fixed(int n, int frac);
+
 private:
    uint32_t base_addr;
    int baud_rate;
+   uint8_t tx_buf[TX_BUF_LEN];   // tx ring buffer
+   uint32_t tx_head;             // # bytes ever queued (mod 2^32)
+   uint32_t tx_tail;             // # bytes ever moved to tx fifo
+   uint32_t tx_drops;            // # bytes dropped on full ring
+   int tx_policy;
+   int queue(uint8_t byte);
    void disp_str(const char *str);
 };
 
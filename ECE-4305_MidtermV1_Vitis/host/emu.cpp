@@ -0,0 +1,196 @@
+/*****************************************************************//**
+ * @file emu.cpp
+ *
+ * @brief MMIO dispatch, virtual clock and statistics of the host build
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "vendor_io.h"
+#include "emu.h"
+#include "emu_models.h"
+#include "emu_devices.h"
+#include "chu_io_map.h"
+
+/* emulated system; created on the first access (firmware globals
+   access their cores from static constructors) */
+struct EmuSystem {
+   uint64_t now;
+   uint64_t max_cycles;       // 0: no limit
+   EmuSlot *slot[EMU_NUM_SLOTS];
+   EmuI2c *i2c[EMU_NUM_SLOTS];
+   EmuIntc intc;
+   EmuTimer *timer;           // alarm irq evaluated on every access
+   std::vector<EmuI2cDevice *> devs;  // i2c devices; ticked on every access
+   uint64_t n_rd[EMU_NUM_SLOTS + 1];  // last entry: io module
+   uint64_t n_wr[EMU_NUM_SLOTS + 1];
+   EmuSystem();
+};
+
+static void emu_exit_report();
+
+static EmuSystem &sys() {
+   static EmuSystem *s = 0;
+
+   if (s == 0) {
+      s = new EmuSystem;
+      atexit(emu_exit_report);
+      // PmodToF on both i2c slots; data-ready irq of slot 4 on INTC input 0
+      if (!getenv("EMU_NO_TOF")) {
+         emu_attach_pmod_tof(S4_USER, 0);
+         emu_attach_pmod_tof(S10_I2C, -1);
+      }
+   }
+   return *s;
+}
+
+EmuSystem::EmuSystem() {
+   const char *env;
+
+   now = 0;
+   max_cycles = 0;
+   env = getenv("EMU_MAX_US");
+   if (env)
+      max_cycles = strtoull(env, 0, 0) * SYS_CLK_FREQ;
+   for (int i = 0; i < EMU_NUM_SLOTS; i++) {
+      slot[i] = 0;
+      i2c[i] = 0;
+      n_rd[i] = n_wr[i] = 0;
+   }
+   n_rd[EMU_NUM_SLOTS] = n_wr[EMU_NUM_SLOTS] = 0;
+   env = getenv("EMU_SW");
+   timer = new EmuTimer;
+   slot[S0_SYS_TIMER] = timer;
+   slot[S1_UART1] = new EmuUart;
+   slot[S2_LED] = new EmuGpo("led");
+   slot[S3_SW] = new EmuGpi(env ? (uint32_t) strtoul(env, 0, 0) : 0);
+   slot[S7_BTN] = new EmuGpi(0);
+   slot[S8_SSEG] = new EmuSseg;
+   slot[S14_TOF_ACQ] = new EmuTofAcq;
+   i2c[S4_USER] = new EmuI2c;
+   i2c[S10_I2C] = new EmuI2c;
+   slot[S4_USER] = i2c[S4_USER];
+   slot[S10_I2C] = i2c[S10_I2C];
+   for (int i = 0; i < EMU_NUM_SLOTS; i++)
+      if (slot[i] == 0)
+         slot[i] = new EmuRegs;
+}
+
+/* address to slot index; EMU_NUM_SLOTS for the io module; -1: unmapped */
+static int decode(uint32_t addr, int *reg) {
+   if (addr >= BRIDGE_BASE) {
+      uint32_t off = (addr - BRIDGE_BASE) >> 2;
+      if (off >= EMU_NUM_SLOTS * 32)
+         return -1;
+      *reg = off & 31;
+      return (int) (off >> 5);
+   }
+   if (addr >= IOMODULE_BASE && addr < IOMODULE_BASE + 0x100) {
+      *reg = (addr - IOMODULE_BASE) >> 2;
+      return EMU_NUM_SLOTS;
+   }
+   return -1;
+}
+
+static void advance(EmuSystem &s) {
+   s.now += EMU_IO_CYCLES;
+   if (s.max_cycles && s.now >= s.max_cycles)
+      exit(0);
+   for (size_t i = 0; i < s.devs.size(); i++)
+      s.devs[i]->tick(s.now);
+   s.timer->update(s.now);
+}
+
+uint32_t emu_read(uint32_t addr) {
+   EmuSystem &s = sys();
+   int reg, k;
+
+   advance(s);
+   k = decode(addr, &reg);
+   if (k < 0) {
+      fprintf(stderr, "emu: read of unmapped address 0x%08x\n", addr);
+      return 0;
+   }
+   s.n_rd[k]++;
+   if (k == EMU_NUM_SLOTS)
+      return s.intc.read(reg, s.now);
+   return s.slot[k]->read(reg, s.now);
+}
+
+void emu_write(uint32_t addr, uint32_t data) {
+   EmuSystem &s = sys();
+   int reg, k;
+
+   advance(s);
+   k = decode(addr, &reg);
+   if (k < 0) {
+      fprintf(stderr, "emu: write of unmapped address 0x%08x\n", addr);
+      return;
+   }
+   s.n_wr[k]++;
+   if (k == EMU_NUM_SLOTS)
+      s.intc.write(reg, data, s.now);
+   else
+      s.slot[k]->write(reg, data, s.now);
+}
+
+uint64_t emu_now() {
+   return sys().now;
+}
+
+void emu_idle(uint64_t cycles) {
+   sys().now += cycles;
+}
+
+void emu_attach_slot(int slot, EmuSlot *model) {
+   EmuSystem &s = sys();
+
+   if (slot >= 0 && slot < EMU_NUM_SLOTS)
+      s.slot[slot] = model;
+}
+
+void emu_attach_i2c(int slot, uint8_t addr, EmuI2cDevice *dev) {
+   EmuSystem &s = sys();
+
+   if (slot < 0 || slot >= EMU_NUM_SLOTS || s.i2c[slot] == 0) {
+      fprintf(stderr, "emu: slot %d is not an i2c core\n", slot);
+      return;
+   }
+   s.i2c[slot]->attach(addr, dev);
+   s.devs.push_back(dev);
+}
+
+void emu_irq(int line, int level) {
+   EmuSystem &s = sys();
+
+   s.intc.input(line, level);
+   if (line == 0)
+      s.timer->cap_input(0, level, s.now);   // ToF irq to timer capture
+}
+
+static void emu_exit_report() {
+   EmuSystem &s = sys();
+   const char *env = getenv("EMU_QUIET");
+
+   fflush(stdout);
+   for (int i = 0; i < EMU_NUM_SLOTS; i++)
+      s.slot[i]->report();
+   if (env && atoi(env))
+      return;
+   fprintf(stderr, "emu: %.6f s virtual time\n",
+         (double) s.now / (SYS_CLK_FREQ * 1e6));
+   fprintf(stderr, "emu: mmio accesses  slot     reads    writes\n");
+   for (int i = 0; i <= EMU_NUM_SLOTS; i++) {
+      if (s.n_rd[i] == 0 && s.n_wr[i] == 0)
+         continue;
+      if (i == EMU_NUM_SLOTS)
+         fprintf(stderr, "emu:               intc");
+      else
+         fprintf(stderr, "emu:               %4d", i);
+      fprintf(stderr, " %9llu %9llu\n", (unsigned long long) s.n_rd[i],
+            (unsigned long long) s.n_wr[i]);
+   }
+}
@@ -0,0 +1,143 @@
+/*****************************************************************//**
+ * @file emu.h
+ *
+ * @brief software models of the MMIO slots for the host build
+ *
+ * Description:
+ * - the firmware (all drivers and main_sampler_test.cpp) is compiled
+ *   for Linux with _VENDOR_IO_ACCESS_USED; io_read()/io_write() call
+ *   emu_read()/emu_write() (vendor_io.h)
+ * - time is virtual: a system clock count (SYS_CLK_FREQ) that advances
+ *   by EMU_IO_CYCLES per MMIO access; models derive their timing
+ *   (uart baud, i2c scl, timer) from it, so busy-wait loops finish
+ *   and timing matches the board to first order
+ * - modeled: timer (slot 0), uart (1), led (2), sw (3), i2c (4, 10),
+ *   btn (7), sseg (8), acquisition engine (14, idle stub) and the
+ *   MCS interrupt controller (IOMODULE_BASE); other slots are plain
+ *   register files (writes stored, read back)
+ * - i2c devices (EmuI2cDevice) attach to a bus by slot and address;
+ *   the PmodToF models (emu_devices.h) sit on slots 4 and 10 unless
+ *   EMU_NO_TOF is set
+ * - environment:
+ *     EMU_MAX_US: stop after this much virtual time (default: run forever)
+ *     EMU_SW:     value of the switches (slot 3)
+ *     EMU_QUIET:  1: no access statistics at exit
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _EMU_H_INCLUDED
+#define _EMU_H_INCLUDED
+
+#include <stdint.h>
+
+#define EMU_IO_CYCLES 8        // clocks per MMIO access (bus + driver code)
+#define EMU_NUM_SLOTS 64       // slots of the FPro bridge
+
+/**
+ * model of one MMIO slot
+ *
+ */
+class EmuSlot {
+public:
+   virtual ~EmuSlot() {}
+   /**
+    * read a register
+    *
+    * @param reg word offset in the slot
+    * @param now current clock count
+    */
+   virtual uint32_t read(int reg, uint64_t now) = 0;
+   /**
+    * write a register
+    *
+    * @param reg word offset in the slot
+    * @param data 32-bit data
+    * @param now current clock count
+    */
+   virtual void write(int reg, uint32_t data, uint64_t now) = 0;
+   /**
+    * print the final state at exit (optional)
+    *
+    */
+   virtual void report() {}
+};
+
+/**
+ * model of an i2c slave device
+ *
+ */
+class EmuI2cDevice {
+public:
+   virtual ~EmuI2cDevice() {}
+   /**
+    * addressed after start/restart
+    *
+    * @param rd 1: read; 0: write
+    * @return 0: ack; 1: nack
+    */
+   virtual int start(int rd) = 0;
+   /**
+    * byte written by the master
+    *
+    * @return 0: ack; 1: nack
+    */
+   virtual int write(uint8_t data) = 0;
+   /**
+    * byte read by the master
+    *
+    * @param last 1: master nacks (last byte)
+    */
+   virtual uint8_t read(int last) = 0;
+   /**
+    * stop condition
+    *
+    */
+   virtual void stop() {}
+   /**
+    * advance device time (called on every MMIO access)
+    *
+    * @param now current clock count
+    */
+   virtual void tick(uint64_t now) { (void) now; }
+};
+
+/**
+ * current virtual clock count
+ *
+ */
+uint64_t emu_now();
+
+/**
+ * let virtual time pass without an access
+ *
+ * @param cycles # clocks
+ */
+void emu_idle(uint64_t cycles);
+
+/**
+ * replace the model of a slot
+ *
+ * @param slot slot number
+ * @param model slot model (owned by caller)
+ */
+void emu_attach_slot(int slot, EmuSlot *model);
+
+/**
+ * attach an i2c device to the bus of an i2c slot
+ *
+ * @param slot slot of the i2c core (e.g., S4_USER)
+ * @param addr 7-bit device address
+ * @param dev device model (owned by caller)
+ */
+void emu_attach_i2c(int slot, uint8_t addr, EmuI2cDevice *dev);
+
+/**
+ * drive an external interrupt input of the MCS (INTC_Interrupt)
+ *
+ * @param line input number (0: bit EXT_INTR_BASE of the controller)
+ * @param level 1: asserted; status bit set on rising edge
+ */
+void emu_irq(int line, int level);
+
+#endif  // _EMU_H_INCLUDED
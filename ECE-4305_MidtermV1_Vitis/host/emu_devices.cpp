@@ -0,0 +1,278 @@
+/*****************************************************************//**
+ * @file emu_devices.cpp
+ *
+ * @brief implementation of the PmodToF device models
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "emu_devices.h"
+#include "chu_io_map.h"
+
+#define US_CYCLES(us) ((uint64_t) (us) * SYS_CLK_FREQ)
+
+/**********************************************************************
+ * ISL29501
+ *********************************************************************/
+enum {
+   INT_PERIOD_REG = 0x10,
+   SAMPLE_PERIOD_REG = 0x11,
+   SAMPLE_CTRL_REG = 0x13,
+   INT_CTRL_REG = 0x60,
+   IRQ_STAT_REG = 0x69,
+   CMD_REG = 0xb0,
+   DIST_MSB_REG = 0xd1,
+   SAMPLE_START_CMD = 0x49,
+   SOFT_RESET_CMD = 0xd7
+};
+
+EmuIsl29501::EmuIsl29501(int irq_line) : rng(29501) {
+   const char *env;
+
+   this->irq_line = irq_line;
+   ptr = 0;
+   first = 0;
+   now = 0;
+   n_conv = 0;
+   d0 = d1 = 1.0;
+   period_s = 0.0;
+   noise_m = 0.003;
+   env = getenv("EMU_TOF_TARGET");
+   if (env) {
+      if (sscanf(env, "%lf,%lf,%lf", &d0, &d1, &period_s) < 3) {
+         d1 = d0;
+         period_s = 0.0;
+      }
+   }
+   env = getenv("EMU_TOF_NOISE_MM");
+   if (env)
+      noise_m = atof(env) / 1000.0;
+   reset();
+}
+
+/* factory defaults */
+void EmuIsl29501::reset() {
+   for (int i = 0; i < 256; i++)
+      regs[i] = 0;
+   regs[0x00] = DEV_ID;
+   regs[INT_PERIOD_REG] = 0x04;
+   regs[SAMPLE_PERIOD_REG] = 0x6e;
+   regs[SAMPLE_CTRL_REG] = 0x7d;    // single shot
+   converting = 0;
+   set_irq(0);
+}
+
+void EmuIsl29501::set_irq(int on) {
+   if (irq_line >= 0)
+      emu_irq(irq_line, on);
+}
+
+uint64_t EmuIsl29501::conv_cycles() {
+   uint64_t ns = (uint64_t) INT_UNIT_NS << (regs[INT_PERIOD_REG] & 0x0f);
+
+   return US_CYCLES(CONV_BASE_US) + ns * SYS_CLK_FREQ / 1000;
+}
+
+uint64_t EmuIsl29501::period_cycles() {
+   return US_CYCLES((uint64_t) (regs[SAMPLE_PERIOD_REG] + 1) * PERIOD_UNIT_US);
+}
+
+/* target distance (m) at clock t: constant or triangle d0..d1 */
+double EmuIsl29501::target(uint64_t t) {
+   double s, x;
+
+   if (period_s <= 0.0)
+      return d0;
+   s = (double) t / US_CYCLES(1000000);
+   x = fmod(s, period_s) / period_s;     // 0..1
+   x = (x < 0.5) ? 2.0 * x : 2.0 * (1.0 - x);
+   return d0 + (d1 - d0) * x;
+}
+
+void EmuIsl29501::start_conversion(uint64_t t) {
+   converting = 1;
+   conv_done = t + conv_cycles();
+}
+
+void EmuIsl29501::command(uint8_t cmd) {
+   if (cmd == SAMPLE_START_CMD)
+      start_conversion(now);
+   else if (cmd == SOFT_RESET_CMD)
+      reset();
+}
+
+void EmuIsl29501::tick(uint64_t now) {
+   std::normal_distribution<double> noise(0.0, noise_m);
+   uint64_t t, next;
+   double d;
+   long raw;
+   long prec;
+
+   this->now = now;
+   while (converting && now >= conv_done) {
+      t = conv_done;
+      d = target(t) + noise(rng);
+      raw = lround(d / 33.31 * 65536.0);
+      raw = (raw < 0) ? 0 : (raw > 0xffff) ? 0xffff : raw;
+      prec = lround(noise_m / 33.31 * 65536.0);
+      prec = (prec > 0xffff) ? 0xffff : prec;
+      regs[DIST_MSB_REG] = (uint8_t) (raw >> 8);
+      regs[DIST_MSB_REG + 1] = (uint8_t) raw;
+      regs[DIST_MSB_REG + 2] = (uint8_t) (prec >> 8);
+      regs[DIST_MSB_REG + 3] = (uint8_t) prec;
+      regs[IRQ_STAT_REG] |= 0x01;
+      if (regs[INT_CTRL_REG] & 0x01)
+         set_irq(1);
+      n_conv++;
+      converting = 0;
+      if (!(regs[SAMPLE_CTRL_REG] & 0x01)) {
+         // continuous: next start one sample period after this one
+         next = conv_done - conv_cycles() + period_cycles();
+         if (next < t)
+            next = t;
+         start_conversion(next);
+      }
+   }
+}
+
+int EmuIsl29501::start(int rd) {
+   if (!rd)
+      first = 1;
+   return 0;
+}
+
+int EmuIsl29501::write(uint8_t data) {
+   if (first) {
+      ptr = data;
+      first = 0;
+      return 0;
+   }
+   if (ptr == CMD_REG)
+      command(data);
+   else if (ptr < DIST_MSB_REG || ptr > DIST_MSB_REG + 3)
+      regs[ptr] = data;     // results are read only
+   ptr++;
+   return 0;
+}
+
+uint8_t EmuIsl29501::read(int last) {
+   uint8_t data = regs[ptr];
+
+   if (ptr == IRQ_STAT_REG) {
+      regs[IRQ_STAT_REG] &= ~0x01;
+      set_irq(0);
+   }
+   ptr++;
+   return data;
+}
+
+void EmuIsl29501::stop() {
+   first = 0;
+}
+
+uint64_t EmuIsl29501::conversions() {
+   return n_conv;
+}
+
+/**********************************************************************
+ * AT24C04
+ *********************************************************************/
+/* example calibration block (marker at 0x20, 13 bytes for DSP 0x24..) */
+static const uint8_t cal_block[14] = {
+   0xa5,
+   0x6f, 0x1c, 0x05, 0x1a, 0xb8, 0x5f, 0x21, 0x3c, 0x0a, 0x00, 0x2d, 0xf2, 0x81
+};
+
+EmuAt24c04::EmuAt24c04() {
+   const char *env = getenv("EMU_EEPROM_FILE");
+   FILE *fp;
+
+   for (int i = 0; i < SIZE; i++)
+      mem[i] = 0xff;
+   for (int i = 0; i < 14; i++)
+      mem[0x20 + i] = cal_block[i];
+   if (env) {
+      fp = fopen(env, "rb");
+      if (fp == 0 || fread(mem, 1, SIZE, fp) != SIZE)
+         fprintf(stderr, "emu: cannot read 512 bytes from %s\n", env);
+      if (fp)
+         fclose(fp);
+   }
+   addr = 0;
+   first = 0;
+   page_dirty = 0;
+   page_base = 0;
+   busy_until = 0;
+   now = 0;
+   for (int i = 0; i < 2; i++) {
+      port[i].rom = this;
+      port[i].blk = i;
+   }
+}
+
+EmuI2cDevice *EmuAt24c04::block(int block) {
+   return &port[block & 1];
+}
+
+int EmuAt24c04::Port::start(int rd) {
+   if (rom->now < rom->busy_until)
+      return 1;            // write cycle in progress: no ack
+   if (!rd)
+      rom->first = 1;
+   return 0;
+}
+
+int EmuAt24c04::Port::write(uint8_t data) {
+   int k;
+
+   if (rom->first) {
+      rom->addr = (uint16_t) ((blk << 8) | data);
+      rom->page_base = rom->addr & ~(PAGE - 1);
+      rom->first = 0;
+      for (k = 0; k < PAGE; k++)
+         rom->page_valid[k] = 0;
+      return 0;
+   }
+   // page write: address rolls over inside the page
+   k = rom->addr & (PAGE - 1);
+   rom->page[k] = data;
+   rom->page_valid[k] = 1;
+   rom->page_dirty = 1;
+   rom->addr = rom->page_base | ((k + 1) & (PAGE - 1));
+   return 0;
+}
+
+uint8_t EmuAt24c04::Port::read(int last) {
+   uint8_t data = rom->mem[rom->addr];
+
+   rom->addr = (rom->addr + 1) & (SIZE - 1);
+   return data;
+}
+
+void EmuAt24c04::Port::stop() {
+   if (!rom->page_dirty)
+      return;
+   for (int k = 0; k < PAGE; k++)
+      if (rom->page_valid[k])
+         rom->mem[rom->page_base + k] = rom->page[k];
+   rom->page_dirty = 0;
+   rom->busy_until = rom->now + US_CYCLES(T_WR_US);
+}
+
+void EmuAt24c04::Port::tick(uint64_t now) {
+   rom->now = now;
+}
+
+/**********************************************************************
+ * PmodToF
+ *********************************************************************/
+void emu_attach_pmod_tof(int slot, int irq_line) {
+   EmuAt24c04 *rom = new EmuAt24c04;
+
+   emu_attach_i2c(slot, 0x57, new EmuIsl29501(irq_line));
+   emu_attach_i2c(slot, 0x50, rom->block(0));
+   emu_attach_i2c(slot, 0x51, rom->block(1));
+}
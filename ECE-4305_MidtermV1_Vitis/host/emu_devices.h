@@ -0,0 +1,136 @@
+/*****************************************************************//**
+ * @file emu_devices.h
+ *
+ * @brief behavioral i2c device models of the PmodToF for the host build
+ *
+ * Description:
+ * - EmuIsl29501: ToF DSP
+ *   - 256-byte register map with auto-increment, factory defaults,
+ *     device id 0x0a at 0x00
+ *   - 0xb0 commands: 0x49 sample start, 0xd7 soft reset
+ *   - conversion time from integration period 0x10 (2^N units);
+ *     continuous mode (0x13 bit 0 clear) repeats at the sample
+ *     period 0x11 (or the conversion time if longer)
+ *   - result 0xd1/0xd2 (distance, 33.31 m full scale) and 0xd3/0xd4
+ *     (precision) from a target trajectory plus gaussian noise
+ *   - data ready: 0x69 bit 0 and the irq output (if 0x60 bit 0 set);
+ *     reading 0x69 clears both
+ * - EmuAt24c04: 512-byte EEPROM at two device addresses (A8 in the
+ *   address), 16-byte page write with 5 ms write cycle (nack while busy);
+ *   calibration block at 0x20 (marker, then 13 bytes for DSP 0x24..0x30)
+ * - timing constants approximate the data sheets; they are model
+ *   parameters, not measured values
+ * - environment:
+ *     EMU_TOF_TARGET:   "d" (m) or "d0,d1,T": triangle d0..d1, period T s
+ *     EMU_TOF_NOISE_MM: standard deviation of distance noise (default 3)
+ *     EMU_EEPROM_FILE:  512-byte image replacing the default contents
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _EMU_DEVICES_H_INCLUDED
+#define _EMU_DEVICES_H_INCLUDED
+
+#include <stdint.h>
+#include <random>
+#include "emu.h"
+
+/**
+ * ISL29501 ToF signal processor
+ *
+ */
+class EmuIsl29501 : public EmuI2cDevice {
+public:
+   enum {
+      DEV_ID = 0x0a,
+      CONV_BASE_US = 1000,     // fixed part of a conversion
+      INT_UNIT_NS = 8192,      // integration time per 2^N unit
+      PERIOD_UNIT_US = 450     // sample period step of 0x11
+   };
+   /**
+    * constructor
+    *
+    * @param irq_line MCS external interrupt input (-1: not wired)
+    */
+   EmuIsl29501(int irq_line);
+   int start(int rd);
+   int write(uint8_t data);
+   uint8_t read(int last);
+   void stop();
+   void tick(uint64_t now);
+   /**
+    * # conversions completed
+    *
+    */
+   uint64_t conversions();
+private:
+   uint8_t regs[256];
+   uint8_t ptr;             // register pointer
+   int first;               // next write byte is the register pointer
+   int converting;
+   uint64_t conv_done;      // clock the conversion completes
+   uint64_t now;
+   uint64_t n_conv;
+   int irq_line;
+   double d0, d1, period_s; // target trajectory
+   double noise_m;
+   std::mt19937 rng;
+   void reset();
+   void command(uint8_t cmd);
+   void start_conversion(uint64_t t);
+   uint64_t conv_cycles();
+   uint64_t period_cycles();
+   double target(uint64_t t);
+   void set_irq(int on);
+};
+
+/**
+ * AT24C04 4-Kbit EEPROM
+ *
+ */
+class EmuAt24c04 {
+public:
+   enum {
+      SIZE = 512,
+      PAGE = 16,
+      T_WR_US = 5000           // self-timed write cycle
+   };
+   EmuAt24c04();
+   /**
+    * device of one 256-byte block
+    *
+    * @param block 0: address 0x50, 1: address 0x51
+    */
+   EmuI2cDevice *block(int block);
+private:
+   class Port : public EmuI2cDevice {
+   public:
+      EmuAt24c04 *rom;
+      int blk;
+      int start(int rd);
+      int write(uint8_t data);
+      uint8_t read(int last);
+      void stop();
+      void tick(uint64_t now);
+   };
+   uint8_t mem[SIZE];
+   Port port[2];
+   uint16_t addr;           // current address
+   int first;               // next write byte is the word address
+   uint8_t page[PAGE];      // pending page write
+   uint8_t page_valid[PAGE];
+   uint16_t page_base;
+   int page_dirty;
+   uint64_t busy_until;
+   uint64_t now;
+};
+
+/**
+ * attach the PmodToF devices (DSP 0x57, EEPROM 0x50/0x51) to an i2c slot
+ *
+ * @param slot i2c slot
+ * @param irq_line MCS external interrupt input of the DSP (-1: none)
+ */
+void emu_attach_pmod_tof(int slot, int irq_line);
+
+#endif  // _EMU_DEVICES_H_INCLUDED
@@ -0,0 +1,488 @@
+/*****************************************************************//**
+ * @file emu_models.cpp
+ *
+ * @brief implementation of the slot models of the host build
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include <cstdio>
+#include <poll.h>
+#include <unistd.h>
+#include "emu_models.h"
+#include "emu.h"
+
+/**********************************************************************
+ * plain register file
+ *********************************************************************/
+EmuRegs::EmuRegs() {
+   for (int i = 0; i < 32; i++)
+      regs[i] = 0;
+}
+
+uint32_t EmuRegs::read(int reg, uint64_t now) {
+   return regs[reg];
+}
+
+void EmuRegs::write(int reg, uint32_t data, uint64_t now) {
+   regs[reg] = data;
+}
+
+/**********************************************************************
+ * timer
+ *  - 0: 32 LSBs of counter, 1: 16 MSBs, 2: ctrl (bit 0 go, bit 1 clear)
+ *  - 3/4: compare value, 5: period, 6: alarm ctrl/status, 7: clear event
+ *  - 8: capture lower/source, 9: capture upper and flags/clear flags
+ *********************************************************************/
+EmuTimer::EmuTimer() {
+   base = 0;
+   t0 = 0;
+   go = 1;
+   cmp = 0;
+   period = 0;
+   armed = irq_en = event = miss = 0;
+   match_cnt = 0;
+   irq = 0;
+   snap = cap = 0;
+   cap_hi = 0;
+   cap_src = cap_valid = cap_ovf = 0;
+   cap_level[0] = cap_level[1] = 0;
+}
+
+/* capture on the rising edge of the selected input */
+void EmuTimer::cap_input(int evt, int level, uint64_t now) {
+   if (level && !cap_level[evt] && cap_src == evt + 1) {
+      cap = count(now);
+      cap_ovf = cap_ovf || cap_valid;
+      cap_valid = 1;
+   }
+   cap_level[evt] = level;
+}
+
+/* matches since the last access are found at once */
+void EmuTimer::update(uint64_t now) {
+   uint64_t c = count(now), n;
+   int level;
+
+   if (armed && c >= cmp) {
+      if (period == 0) {
+         miss = miss || event;
+         armed = 0;
+         match_cnt = cmp;
+      } else {
+         n = (c - cmp) / period + 1;
+         miss = miss || event || n > 1;
+         match_cnt = cmp + (n - 1) * period;
+         cmp += n * period;
+      }
+      event = 1;
+   }
+   level = event && irq_en;
+   if (level != irq) {
+      irq = level;
+      emu_irq(1, level);
+   }
+}
+
+uint64_t EmuTimer::count(uint64_t now) {
+   return (base + (go ? now - t0 : 0)) & 0xffffffffffffULL;
+}
+
+uint32_t EmuTimer::read(int reg, uint64_t now) {
+   update(now);
+   switch (reg) {
+   case 0:
+      snap = count(now);
+      return (uint32_t) snap;
+   case 1:
+      return (uint32_t) (snap >> 32);
+   case 3:
+      return (uint32_t) cmp;
+   case 4:
+      return (uint32_t) (cmp >> 32);
+   case 5:
+      return period;
+   case 6:
+      return armed | (irq_en << 1) | (event << 2) | (miss << 3);
+   case 8:
+      cap_hi = (uint32_t) (cap >> 32) | (cap_valid << 16) | (cap_ovf << 17);
+      return (uint32_t) cap;
+   case 9:
+      return cap_hi;
+   default:
+      return (uint32_t) count(now);
+   }
+}
+
+void EmuTimer::write(int reg, uint32_t data, uint64_t now) {
+   update(now);
+   switch (reg) {
+   case 2:
+      base = (data & 0x02) ? 0 : count(now);
+      t0 = now;
+      go = data & 0x01;
+      break;
+   case 3:
+      cmp = (cmp & 0xffff00000000ULL) | data;
+      break;
+   case 4:
+      cmp = (cmp & 0xffffffffULL) | ((uint64_t) (data & 0xffff) << 32);
+      break;
+   case 5:
+      period = data;
+      break;
+   case 6:
+      armed = data & 0x01;
+      irq_en = (data >> 1) & 0x01;
+      event = miss = 0;
+      break;
+   case 7:
+      // a match in the clock of the ack wins (new event, no miss)
+      event = event && go && match_cnt == count(now);
+      miss = 0;
+      break;
+   case 8:
+      cap_src = data & 0x03;
+      cap_valid = cap_ovf = 0;
+      break;
+   case 9:
+      cap_valid = cap_ovf = 0;
+      break;
+   }
+   update(now);
+}
+
+/**********************************************************************
+ * uart
+ *  - 0: {tx free, 6'b0, tx full, rx empty, rx data}
+ *  - 1: baud rate increment, 2: tx data, 3: remove rx data
+ *********************************************************************/
+EmuUart::EmuUart() {
+   inc = 0;
+   tx_next = 0;
+   rx_eof = 0;
+}
+
+/* 10 bits of 16 ticks; tick every 2^24/inc clocks */
+uint64_t EmuUart::byte_cycles() {
+   return (160ULL << 24) / inc;
+}
+
+void EmuUart::update(uint64_t now) {
+   struct pollfd pfd;
+   uint8_t byte;
+
+   // tx: bytes leave the fifo at the baud rate
+   while (!tx_fifo.empty() && inc != 0 && now >= tx_next) {
+      fputc(tx_fifo.front(), stdout);
+      tx_fifo.pop_front();
+      tx_next += byte_cycles();
+   }
+   // rx: whatever stdin has ready
+   if (rx_fifo.empty() && !rx_eof) {
+      pfd.fd = 0;
+      pfd.events = POLLIN;
+      if (poll(&pfd, 1, 0) > 0) {
+         if (::read(0, &byte, 1) == 1)
+            rx_fifo.push_back(byte);
+         else
+            rx_eof = 1;
+      }
+   }
+}
+
+uint32_t EmuUart::read(int reg, uint64_t now) {
+   uint32_t free;
+
+   update(now);
+   free = FIFO_DEPTH - tx_fifo.size();
+   return (free << 16) | ((free == 0) << 9) | (rx_fifo.empty() << 8) |
+         (rx_fifo.empty() ? 0 : rx_fifo.front());
+}
+
+void EmuUart::write(int reg, uint32_t data, uint64_t now) {
+   update(now);
+   switch (reg) {
+   case 1:
+      inc = data & 0xffffff;
+      break;
+   case 2:
+      if (tx_fifo.size() >= FIFO_DEPTH)
+         break;
+      if (tx_fifo.empty())
+         tx_next = now + (inc ? byte_cycles() : 0);
+      tx_fifo.push_back((uint8_t) data);
+      break;
+   case 3:
+      if (!rx_fifo.empty())
+         rx_fifo.pop_front();
+      break;
+   }
+}
+
+/* bytes still in the fifo at exit are sent as well */
+void EmuUart::report() {
+   while (!tx_fifo.empty()) {
+      fputc(tx_fifo.front(), stdout);
+      tx_fifo.pop_front();
+   }
+   fflush(stdout);
+}
+
+/**********************************************************************
+ * gpo/gpi
+ *********************************************************************/
+EmuGpo::EmuGpo(const char *name) {
+   this->name = name;
+   data = 0;
+}
+
+uint32_t EmuGpo::read(int reg, uint64_t now) {
+   return 0;
+}
+
+void EmuGpo::write(int reg, uint32_t data, uint64_t now) {
+   if (reg == 0)
+      this->data = data;
+}
+
+void EmuGpo::report() {
+   fprintf(stderr, "emu: %s = 0x%08x\n", name, data);
+}
+
+EmuGpi::EmuGpi(uint32_t value) {
+   this->value = value;
+}
+
+uint32_t EmuGpi::read(int reg, uint64_t now) {
+   return value;
+}
+
+void EmuGpi::write(int reg, uint32_t data, uint64_t now) {
+}
+
+/**********************************************************************
+ * seven-segment display
+ *  - 0: patterns of digits 3-0, 1: digits 7-4 (active low, bit 7 dp)
+ *********************************************************************/
+EmuSseg::EmuSseg() {
+   low = 0xffffffff;
+   high = 0xffffffff;
+}
+
+uint32_t EmuSseg::read(int reg, uint64_t now) {
+   return 0;
+}
+
+void EmuSseg::write(int reg, uint32_t data, uint64_t now) {
+   if (reg == 0)
+      low = data;
+   else if (reg == 1)
+      high = data;
+}
+
+void EmuSseg::report() {
+   static const uint8_t PTN_TABLE[16] =
+     {0xc0, 0xf9, 0xa4, 0xb0, 0x99, 0x92, 0x82, 0xf8, 0x80, 0x90,
+      0x88, 0x83, 0xc6, 0xa1, 0x86, 0x8e };
+   char text[17];
+   int k = 0;
+
+   // digit 7 is the leftmost
+   for (int pos = 7; pos >= 0; pos--) {
+      uint8_t ptn = (uint8_t) (((pos < 4) ? low : high) >> (8 * (pos & 3)));
+      char ch = '?';
+      if ((ptn | 0x80) == 0xff)
+         ch = ' ';
+      for (int d = 0; d < 16; d++)
+         if ((ptn | 0x80) == PTN_TABLE[d])
+            ch = (char) ((d < 10) ? '0' + d : 'a' + d - 10);
+      text[k++] = ch;
+      if (!(ptn & 0x80))
+         text[k++] = '.';
+   }
+   text[k] = '\0';
+   fprintf(stderr, "emu: sseg = [%s]\n", text);
+}
+
+/**********************************************************************
+ * acquisition engine stub
+ *********************************************************************/
+EmuTofAcq::EmuTofAcq() {
+   warned = 0;
+}
+
+uint32_t EmuTofAcq::read(int reg, uint64_t now) {
+   return (reg == 0) ? 0x00000002 : 0;   // FIFO empty
+}
+
+void EmuTofAcq::write(int reg, uint32_t data, uint64_t now) {
+   if (reg == 0 && (data & 0x01) && !warned) {
+      fprintf(stderr, "emu: acquisition engine (slot 14) not modeled\n");
+      warned = 1;
+   }
+}
+
+/**********************************************************************
+ * i2c
+ *  - 0: {rx empty, cmd full, ack, ready, data}, 1: divisor,
+ *    2: push {log, cmd, data}, 3: {rx empty, ack, data} / remove
+ *********************************************************************/
+enum { I2C_START = 0, I2C_WR = 1, I2C_RD = 2, I2C_STOP = 3, I2C_RESTART = 4 };
+
+EmuI2c::EmuI2c() {
+   dvsr = 0;
+   sel = 0;
+   expect_addr = 0;
+   cur_valid = 0;
+   cur_done = 0;
+   bus_free = 0;
+   dout = res_dout = 0;
+   ack = res_ack = 0;
+}
+
+void EmuI2c::attach(uint8_t addr, EmuI2cDevice *dev) {
+   devs[addr] = dev;
+}
+
+uint64_t EmuI2c::duration(uint32_t word) {
+   uint64_t q = (dvsr == 0) ? 1 : dvsr;
+
+   switch ((word >> 8) & 0x07) {
+   case I2C_START:   return 3 * q;
+   case I2C_STOP:    return 4 * q;
+   case I2C_RESTART: return 5 * q;
+   default:          return 37 * q;    // 9 bits plus data_end
+   }
+}
+
+/* bus effect of one command; result kept in res_dout/res_ack */
+void EmuI2c::execute(uint32_t word) {
+   uint8_t data = word & 0xff;
+   std::map<uint8_t, EmuI2cDevice *>::iterator it;
+
+   res_dout = data;
+   res_ack = 0;
+   switch ((word >> 8) & 0x07) {
+   case I2C_START:
+   case I2C_RESTART:
+      expect_addr = 1;
+      break;
+   case I2C_STOP:
+      if (sel)
+         sel->stop();
+      sel = 0;
+      expect_addr = 0;
+      break;
+   case I2C_WR:
+      if (expect_addr) {
+         expect_addr = 0;
+         if (sel)
+            sel->stop();      // restart to another transfer
+         sel = 0;
+         it = devs.find(data >> 1);
+         res_ack = 1;
+         if (it != devs.end()) {
+            res_ack = it->second->start(data & 0x01);
+            if (res_ack == 0)
+               sel = it->second;
+         }
+      } else
+         res_ack = sel ? sel->write(data) : 1;
+      break;
+   default:   // read; bit 0 of data: master nacks
+      res_dout = sel ? sel->read(data & 0x01) : 0xff;
+      res_ack = data & 0x01;
+      break;
+   }
+}
+
+void EmuI2c::update(uint64_t now) {
+   for (;;) {
+      if (cur_valid) {
+         if (now < cur_done)
+            break;
+         dout = res_dout;
+         ack = res_ack;
+         if ((cur.word & 0x800) && rx_fifo.size() < FIFO_DEPTH)
+            rx_fifo.push_back(((uint32_t) ack << 8) | dout);
+         cur_valid = 0;
+      }
+      if (cmd_fifo.empty())
+         break;
+      cur = cmd_fifo.front();
+      cmd_fifo.pop_front();
+      cur_done = ((bus_free > cur.t) ? bus_free : cur.t) + duration(cur.word);
+      bus_free = cur_done;
+      execute(cur.word);
+      cur_valid = 1;
+   }
+}
+
+uint32_t EmuI2c::read(int reg, uint64_t now) {
+   int ready;
+
+   update(now);
+   if ((reg & 0x03) == 3)
+      return (rx_fifo.empty() << 9) | (rx_fifo.empty() ? 0 : rx_fifo.front());
+   ready = cmd_fifo.empty() && !cur_valid;
+   return (rx_fifo.empty() << 11) | ((cmd_fifo.size() >= FIFO_DEPTH) << 10) |
+         (ack << 9) | (ready << 8) | dout;
+}
+
+void EmuI2c::write(int reg, uint32_t data, uint64_t now) {
+   cmd_t c;
+
+   update(now);
+   switch (reg & 0x03) {
+   case 1:
+      dvsr = data & 0xffff;
+      break;
+   case 2:
+      if (cmd_fifo.size() >= FIFO_DEPTH)
+         break;
+      c.word = data & 0xfff;
+      c.t = now;
+      cmd_fifo.push_back(c);
+      update(now);
+      break;
+   case 3:
+      if (!rx_fifo.empty())
+         rx_fifo.pop_front();
+      break;
+   }
+}
+
+/**********************************************************************
+ * interrupt controller
+ *  - 0x30 status, 0x34 pending, 0x38 enable, 0x3c ack
+ *  - external input n sets status bit 16+n on its rising edge
+ *********************************************************************/
+EmuIntc::EmuIntc() {
+   status = 0;
+   enable = 0;
+   level = 0;
+}
+
+uint32_t EmuIntc::read(int reg, uint64_t now) {
+   if (reg == 0x30 / 4)
+      return status;
+   if (reg == 0x34 / 4)
+      return status & enable;
+   return 0;
+}
+
+void EmuIntc::write(int reg, uint32_t data, uint64_t now) {
+   if (reg == 0x38 / 4)
+      enable = data;
+   else if (reg == 0x3c / 4)
+      status = status & ~data;
+}
+
+void EmuIntc::input(int line, int level) {
+   uint32_t bit = 1u << line;
+
+   if (level && !(this->level & bit))
+      status = status | (bit << 16);
+   this->level = level ? (this->level | bit) : (this->level & ~bit);
+}
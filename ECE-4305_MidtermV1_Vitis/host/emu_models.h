@@ -0,0 +1,188 @@
+/*****************************************************************//**
+ * @file emu_models.h
+ *
+ * @brief slot models of the host build
+ *
+ * Description:
+ * - register maps follow the HDL cores (chu_*.sv) and the drivers
+ * - all timing is in clocks of the virtual system clock (emu.h)
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _EMU_MODELS_H_INCLUDED
+#define _EMU_MODELS_H_INCLUDED
+
+#include <deque>
+#include <map>
+#include "emu.h"
+
+/**
+ * plain register file (unmodeled slots)
+ *
+ */
+class EmuRegs : public EmuSlot {
+public:
+   EmuRegs();
+   uint32_t read(int reg, uint64_t now);
+   void write(int reg, uint32_t data, uint64_t now);
+private:
+   uint32_t regs[32];
+};
+
+/**
+ * chu_timer: 48-bit clock counter with go/clear, compare/alarm and
+ * event capture; the alarm irq drives INTC input 1, capture event 0 is
+ * the ToF irq (INTC input 0)
+ *
+ */
+class EmuTimer : public EmuSlot {
+public:
+   EmuTimer();
+   uint32_t read(int reg, uint64_t now);
+   void write(int reg, uint32_t data, uint64_t now);
+   void update(uint64_t now);   // alarm match and irq level
+   void cap_input(int evt, int level, uint64_t now);
+private:
+   uint64_t base;    // count at t0
+   uint64_t t0;      // clock of last go/pause/clear
+   int go;
+   uint64_t cmp;     // compare value
+   uint32_t period;  // 0: one-shot
+   int armed, irq_en, event, miss;
+   uint64_t match_cnt; // counter value of the last match
+   int irq;          // level driven on INTC input 1
+   uint64_t snap;    // counter at the last lower read
+   uint64_t cap;     // captured counter
+   uint32_t cap_hi;  // {ovf, valid, cap[47:32]} at the last capture read
+   int cap_src, cap_valid, cap_ovf;
+   int cap_level[2]; // capture event inputs
+   uint64_t count(uint64_t now);
+};
+
+/**
+ * chu_uart: tx to stdout and rx from stdin, paced by the baud rate
+ *
+ */
+class EmuUart : public EmuSlot {
+public:
+   enum { FIFO_DEPTH = 256 };
+   EmuUart();
+   uint32_t read(int reg, uint64_t now);
+   void write(int reg, uint32_t data, uint64_t now);
+   void report();
+private:
+   uint32_t inc;                 // baud rate increment
+   std::deque<uint8_t> tx_fifo;
+   std::deque<uint8_t> rx_fifo;
+   uint64_t tx_next;             // clock the head byte leaves the fifo
+   int rx_eof;
+   uint64_t byte_cycles();
+   void update(uint64_t now);
+};
+
+/**
+ * chu_gpo: output register (e.g., led)
+ *
+ */
+class EmuGpo : public EmuSlot {
+public:
+   EmuGpo(const char *name);
+   uint32_t read(int reg, uint64_t now);
+   void write(int reg, uint32_t data, uint64_t now);
+   void report();
+private:
+   const char *name;
+   uint32_t data;
+};
+
+/**
+ * chu_gpi/debounce: constant input value
+ *
+ */
+class EmuGpi : public EmuSlot {
+public:
+   EmuGpi(uint32_t value);
+   uint32_t read(int reg, uint64_t now);
+   void write(int reg, uint32_t data, uint64_t now);
+private:
+   uint32_t value;
+};
+
+/**
+ * chu_led_mux_core: eight 7-segment patterns; shown at exit
+ *
+ */
+class EmuSseg : public EmuSlot {
+public:
+   EmuSseg();
+   uint32_t read(int reg, uint64_t now);
+   void write(int reg, uint32_t data, uint64_t now);
+   void report();
+private:
+   uint32_t low, high;
+};
+
+/**
+ * chu_tof_acq_core: not modeled; sample FIFO always empty
+ *
+ */
+class EmuTofAcq : public EmuSlot {
+public:
+   EmuTofAcq();
+   uint32_t read(int reg, uint64_t now);
+   void write(int reg, uint32_t data, uint64_t now);
+private:
+   int warned;
+};
+
+/**
+ * chu_i2c_core: command/read-data FIFOs and a bus with device models
+ * - command durations follow i2c_master (dvsr = quarter scl period):
+ *   start 3, byte 37, restart 5, stop 4 quarter periods
+ *
+ */
+class EmuI2c : public EmuSlot {
+public:
+   enum { FIFO_DEPTH = 32 };
+   EmuI2c();
+   uint32_t read(int reg, uint64_t now);
+   void write(int reg, uint32_t data, uint64_t now);
+   void attach(uint8_t addr, EmuI2cDevice *dev);
+private:
+   struct cmd_t {
+      uint32_t word;     // {log, cmd, data}
+      uint64_t t;        // clock pushed
+   };
+   uint32_t dvsr;
+   std::deque<cmd_t> cmd_fifo;
+   std::deque<uint32_t> rx_fifo;     // {ack, data}
+   std::map<uint8_t, EmuI2cDevice *> devs;
+   EmuI2cDevice *sel;                // addressed device
+   int expect_addr;                  // next write is a device address
+   int cur_valid;
+   cmd_t cur;
+   uint64_t cur_done, bus_free;
+   uint8_t dout, res_dout;
+   int ack, res_ack;
+   void update(uint64_t now);
+   void execute(uint32_t word);
+   uint64_t duration(uint32_t word);
+};
+
+/**
+ * MCS io module interrupt controller (edge-triggered external inputs)
+ *
+ */
+class EmuIntc {
+public:
+   EmuIntc();
+   uint32_t read(int reg, uint64_t now);
+   void write(int reg, uint32_t data, uint64_t now);
+   void input(int line, int level);
+private:
+   uint32_t status, enable;
+   uint32_t level;     // current external input levels
+};
+
+#endif  // _EMU_MODELS_H_INCLUDED
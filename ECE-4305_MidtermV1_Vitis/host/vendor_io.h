@@ -0,0 +1,36 @@
+/*****************************************************************//**
+ * @file vendor_io.h
+ *
+ * @brief io_read()/io_write() of the host (emulated MMIO) build
+ *
+ * Description:
+ * - included by chu_io_rw.h when _VENDOR_IO_ACCESS_USED is defined
+ * - every access goes to the slot models of emu.h at the same
+ *   addresses as on the board (chu_io_map.h)
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _VENDOR_IO_H_INCLUDED
+#define _VENDOR_IO_H_INCLUDED
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t emu_read(uint32_t addr);
+void emu_write(uint32_t addr, uint32_t data);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#define io_read(base_addr, offset) \
+   emu_read((uint32_t) (base_addr) + 4*(offset))
+
+#define io_write(base_addr, offset, data) \
+   emu_write((uint32_t) (base_addr) + 4*(offset), (uint32_t) (data))
+
+#endif  // _VENDOR_IO_H_INCLUDED
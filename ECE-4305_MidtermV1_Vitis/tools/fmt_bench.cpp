@@ -0,0 +1,226 @@
+/*****************************************************************//**
+ * @file fmt_bench.cpp
+ *
+ * @brief host benchmark of the UartCore number formatting
+ *
+ * Description:
+ * - "div": conversion of the original UartCore::disp(n, base, len) and
+ *   disp_fixed() (runtime-base "%" and "/" per digit, char by char)
+ * - "fmt": num_fmt.h (power-of-ten subtraction, shifts, digit table)
+ * - both render into a buffer; outputs are compared for every test
+ *   value before timing
+ * - a host cpu has a fast hardware divider and penalizes the branchy
+ *   subtraction loop, so host times favor "div"; the MicroBlaze MCS has
+ *   no divider (each "/" or "%" is a __udivsi3 call, a 32-step
+ *   shift-subtract loop), so per-conversion operation counts are also
+ *   reported and turned into an MCS cycle estimate
+ * - usage: fmt_bench [n]   (n: # values per pass, default 1000000)
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include "../ECE-4305_MidtermV1_Application/src/num_fmt.h"
+
+/* original UartCore::disp(int n, int base, int len) conversion */
+static int div_int(char *out, int n, int base, int len) {
+   char buf[33];         // 32 bit #
+   char *str, ch, sign;
+   int rem, i;
+   unsigned int un;
+
+   if (base != 2 && base != 8 && base != 16)
+      base = 10;
+   if (len > 32)
+      len = 32;
+   if (base == 10 && n < 0) {
+      un = (unsigned) -n;
+      sign = '-';
+   } else {
+      un = (unsigned) n;
+      sign = ' ';
+   }
+   str = &buf[32];
+   *str = '\0';
+   i = 0;
+   do {
+      str--;
+      rem = un % base;
+      un = un / base;
+      if (rem < 10)
+         ch = (char) rem + '0';
+      else
+         ch = (char) rem - 10 + 'a';
+      *str = ch;
+      i++;
+   } while (un);
+   if (sign == '-') {
+      str--;
+      *str = sign;
+      i++;
+   }
+   while (i < len) {
+      str--;
+      *str = ' ';
+      i++;
+   };
+   // original sent the string one tx_byte() at a time
+   for (i = 0; str[i]; i++)
+      out[i] = str[i];
+   return i;
+}
+
+/* original UartCore::disp_fixed() conversion */
+static int div_fixed(char *out, int n, int frac) {
+   char buf[13];
+   char *str;
+   unsigned int un;
+   int i;
+
+   if (frac > 9)
+      frac = 9;
+   un = (n < 0) ? (unsigned) -n : (unsigned) n;
+   str = &buf[12];
+   *str = '\0';
+   i = 0;
+   do {
+      if (i == frac && frac > 0) {
+         str--;
+         *str = '.';
+      }
+      str--;
+      *str = (char) (un % 10) + '0';
+      un = un / 10;
+      i++;
+   } while (un || i <= frac);
+   if (n < 0) {
+      str--;
+      *str = '-';
+   }
+   for (i = 0; str[i]; i++)
+      out[i] = str[i];
+   return i;
+}
+
+static uint32_t rng = 12345;
+static uint32_t next_val() {
+   rng = rng * 1664525 + 1013904223;
+   return rng;
+}
+
+/* values with a realistic spread of magnitudes */
+static int test_val(int i) {
+   uint32_t r = next_val();
+   switch (i & 3) {
+   case 0:  return (int) (r % 100);
+   case 1:  return (int) (r % 100000);
+   case 2:  return (int) (r % 34000000);  // um distance range
+   default: return (int) r;
+   }
+}
+
+static int check() {
+   static const int edge[] = {0, 1, 9, 10, 99, 100, 999999, 1000000,
+      2147483647, -1, -10, -2147483647 - 1};
+   char a[64], b[64];
+   int bases[4] = {2, 8, 10, 16};
+   int errs = 0;
+
+   for (int k = 0; k < 200000 + 12; k++) {
+      int n = (k < 12) ? edge[k] : test_val(k);
+      for (int j = 0; j < 4; j++) {
+         int la = div_int(a, n, bases[j], k % 12);
+         int lb = fmt_int(b, n, bases[j], k % 12);
+         if (la != lb || memcmp(a, b, la) != 0) {
+            if (errs++ < 5)
+               printf("int mismatch: %d base %d: '%.*s' vs '%.*s'\n", n,
+                     bases[j], la, a, lb, b);
+         }
+      }
+      for (int frac = 0; frac <= 9; frac++) {
+         int la = div_fixed(a, n, frac);
+         int lb = fmt_fixed(b, n, frac);
+         if (la != lb || memcmp(a, b, la) != 0) {
+            if (errs++ < 5)
+               printf("fixed mismatch: %d frac %d: '%.*s' vs '%.*s'\n", n,
+                     frac, la, a, lb, b);
+         }
+      }
+   }
+   return errs;
+}
+
+/* MCS cost model (cycles): one library division; one subtract/compare step */
+#define MCS_DIV_CYCLES 160
+#define MCS_STEP_CYCLES 4
+
+/* average # divisions (div) and subtract/compare steps (fmt) per decimal
+   conversion, and the resulting MCS cycle estimate */
+static void mcs_estimate(const int *vals, int num) {
+   double divs = 0, steps = 0;
+
+   for (int i = 0; i < num; i++) {
+      uint32_t un = (vals[i] < 0) ? (uint32_t) -vals[i] : (uint32_t) vals[i];
+      int digits = 0, sum = 0;
+      do {
+         sum += un % 10;
+         un /= 10;
+         digits++;
+      } while (un);
+      divs += 2 * digits;              // "%" and "/" per digit
+      steps += sum + digits + (10 - digits);  // subtracts, compares, skips
+   }
+   divs /= num;
+   steps /= num;
+   printf("MCS estimate, disp(n, 10): div %.1f divisions ~%.0f cycles, "
+         "fmt %.1f steps ~%.0f cycles\n", divs, divs * MCS_DIV_CYCLES, steps,
+         steps * MCS_STEP_CYCLES);
+}
+
+typedef int (*int_fn)(char *, int, int, int);
+typedef int (*fixed_fn)(char *, int, int);
+
+static volatile int sink;
+
+static double time_int(int_fn fn, const int *vals, int num, int base) {
+   char buf[64];
+   auto t0 = std::chrono::steady_clock::now();
+   for (int i = 0; i < num; i++)
+      sink += fn(buf, vals[i], base, 0) + buf[0];
+   auto t1 = std::chrono::steady_clock::now();
+   return std::chrono::duration<double, std::nano>(t1 - t0).count() / num;
+}
+
+static double time_fixed(fixed_fn fn, const int *vals, int num, int frac) {
+   char buf[64];
+   auto t0 = std::chrono::steady_clock::now();
+   for (int i = 0; i < num; i++)
+      sink += fn(buf, vals[i], frac) + buf[0];
+   auto t1 = std::chrono::steady_clock::now();
+   return std::chrono::duration<double, std::nano>(t1 - t0).count() / num;
+}
+
+int main(int argc, char **argv) {
+   int num = (argc > 1) ? atoi(argv[1]) : 1000000;
+   int *vals = new int[num];
+   int errs;
+
+   errs = check();
+   printf("cross-check: %d mismatch(es)\n", errs);
+   for (int i = 0; i < num; i++)
+      vals[i] = test_val(i);
+   printf("ns/conversion          div      fmt\n");
+   printf("disp(n, 10)       %8.1f %8.1f\n",
+         time_int(div_int, vals, num, 10), time_int(fmt_int, vals, num, 10));
+   printf("disp(n, 16)       %8.1f %8.1f\n",
+         time_int(div_int, vals, num, 16), time_int(fmt_int, vals, num, 16));
+   printf("disp_fixed(n, 6)  %8.1f %8.1f\n",
+         time_fixed(div_fixed, vals, num, 6), time_fixed(fmt_fixed, vals, num, 6));
+   mcs_estimate(vals, num);
+   delete[] vals;
+   return errs ? 1 : 0;
+}
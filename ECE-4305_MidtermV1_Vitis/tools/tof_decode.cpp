@@ -0,0 +1,153 @@
+/*****************************************************************//**
+ * @file tof_decode.cpp
+ *
+ * @brief Linux decoder of the binary ToF telemetry stream
+ *
+ * Description:
+ * - reads frames (see telemetry.h) from a serial device or stdin
+ * - hunts for the sync word, checks the CRC and prints one line per
+ *   sample: sequence number, time stamp, raw distance, distance, status
+ * - frames with a bad CRC are skipped one byte at a time (resync);
+ *   text output of the board between frames is ignored
+ * - sequence gaps (lost frames) are counted
+ * - usage: tof_decode [-b baud] [-m] [device]
+ *     -b: baud rate of the device (default 9600)
+ *     -m: send 'b' to switch the board to binary output first
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include "../ECE-4305_MidtermV1_Application/src/telemetry.h"
+
+/* same conversion as ISL29501_raw_to_um() of the firmware */
+static uint32_t raw_to_um(uint16_t raw) {
+   return (uint32_t) raw * 508 + (((uint32_t) raw * 1107) >> 12);
+}
+
+static speed_t baud_code(int baud) {
+   switch (baud) {
+   case 9600:    return B9600;
+   case 19200:   return B19200;
+   case 38400:   return B38400;
+   case 57600:   return B57600;
+   case 115200:  return B115200;
+   case 230400:  return B230400;
+   case 460800:  return B460800;
+   case 921600:  return B921600;
+#ifdef B2000000      // Linux rates above 921600 (2 Mbaud: see uart tuning)
+   case 1000000: return B1000000;
+   case 1152000: return B1152000;
+   case 1500000: return B1500000;
+   case 2000000: return B2000000;
+   case 2500000: return B2500000;
+   case 3000000: return B3000000;
+#endif
+   default:      return 0;
+   }
+}
+
+/* raw 8N1 mode */
+static int open_serial(const char *dev, int baud) {
+   struct termios tio;
+   speed_t code = baud_code(baud);
+   int fd;
+
+   if (code == 0) {
+      fprintf(stderr, "unsupported baud rate %d\n", baud);
+      return -1;
+   }
+   fd = open(dev, O_RDWR | O_NOCTTY);
+   if (fd < 0) {
+      perror(dev);
+      return -1;
+   }
+   if (tcgetattr(fd, &tio) == 0) {
+      cfmakeraw(&tio);
+      cfsetispeed(&tio, code);
+      cfsetospeed(&tio, code);
+      tio.c_cflag |= CLOCAL | CREAD;
+      tio.c_cc[VMIN] = 1;
+      tio.c_cc[VTIME] = 0;
+      tcsetattr(fd, TCSANOW, &tio);
+   }
+   return fd;
+}
+
+static void print_frame(const uint8_t *f) {
+   uint16_t seq = f[2] | (f[3] << 8);
+   uint32_t tick = f[4] | (f[5] << 8) | (f[6] << 16) | ((uint32_t) f[7] << 24);
+   uint16_t raw = f[8] | (f[9] << 8);
+   uint8_t status = f[10];
+   uint32_t um = raw_to_um(raw);
+
+   printf("%5u %10lu %5u %2u.%06lu m  sensor %u%s%s%s\n", seq,
+         (unsigned long) tick, raw, (unsigned) (um / 1000000),
+         (unsigned long) (um % 1000000), status >> 4,
+         (status & TLM_NACK) ? " nack" : "",
+         (status & TLM_TIMEOUT) ? " timeout" : "",
+         (status & TLM_OVERFLOW) ? " overflow" : "");
+}
+
+int main(int argc, char **argv) {
+   uint8_t buf[4096];
+   int fd = 0, baud = 9600, set_mode = 0, len = 0, n, i;
+   unsigned long frames = 0, crc_err = 0, lost = 0;
+   int have_seq = 0;
+   uint16_t next_seq = 0;
+   const char *dev = 0;
+
+   for (i = 1; i < argc; i++) {
+      if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+         baud = atoi(argv[++i]);
+      else if (strcmp(argv[i], "-m") == 0)
+         set_mode = 1;
+      else
+         dev = argv[i];
+   }
+   if (dev) {
+      fd = open_serial(dev, baud);
+      if (fd < 0)
+         return 1;
+      if (set_mode && write(fd, "b", 1) != 1)
+         perror("write");
+   }
+   setvbuf(stdout, 0, _IOLBF, 0);
+   printf("  seq       tick   raw     distance  status\n");
+   while ((n = read(fd, buf + len, sizeof(buf) - len)) > 0) {
+      len += n;
+      i = 0;
+      while (len - i >= TLM_FRAME_LEN) {
+         const uint8_t *f = buf + i;
+         if (f[0] != TLM_SYNC0 || f[1] != TLM_SYNC1) {
+            i++;
+            continue;
+         }
+         uint16_t crc = f[11] | (f[12] << 8);
+         if (tlm_crc16(&f[2], 9) != crc) {
+            crc_err++;
+            i++;      // false sync or corrupted frame: hunt again
+            continue;
+         }
+         uint16_t seq = f[2] | (f[3] << 8);
+         if (have_seq && seq != next_seq)
+            lost += (uint16_t) (seq - next_seq);
+         have_seq = 1;
+         next_seq = seq + 1;
+         frames++;
+         print_frame(f);
+         i += TLM_FRAME_LEN;
+      }
+      memmove(buf, buf + i, len - i);
+      len -= i;
+   }
+   fprintf(stderr, "%lu frame(s), %lu crc error(s), %lu lost\n", frames,
+         crc_err, lost);
+   return 0;
+}
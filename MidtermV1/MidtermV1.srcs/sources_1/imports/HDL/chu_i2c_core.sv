@@ -1,4 +1,28 @@
+//  * Reg map:
+//    * 0: read data and status
+//        bits 7-0: data of last read/write command
+//        bit 8: ready (command FIFO empty and master idle)
+//        bit 9: ack of last write command
+//        bit 10: command FIFO full
+//        bit 11: read-data FIFO empty
+//    * 1: write divisor
+//    * 2: write command (pushed into command FIFO)
+//        bits 7-0: data
+//        bits 10-8: command
+//        bit 11: log; push {ack, data} into read-data FIFO when done
+//    * 3: read: head of read-data FIFO
+//        bits 7-0: data, bit 8: ack, bit 9: read-data FIFO empty
+//         write: dummy write to remove data from head of read-data FIFO
+//  * a whole transaction (start, address, writes/reads, stop) can be
+//    pushed back-to-back; the master executes the commands without
+//    cpu polling between bytes
+//  * external command port (e.g., acquisition engine):
+//    * ext_en hands the master over to the external port;
+//      the cpu must not issue commands while ext_en is asserted
+//    * ext_wr/ext_cmd/ext_din have the same meaning as in i2c_master
+
 module chu_i2c_core
+   #(parameter FIFO_DEPTH_BIT = 5)  // # addr bits of command/read FIFOs
    (
     input  logic clk,
     input  logic reset,
@@ -9,36 +33,79 @@ module chu_i2c_core
     input  logic [4:0] addr,
     input  logic [31:0] wr_data,
     output logic [31:0] rd_data,
-    // external signal    
-    output tri scl,
-    inout  tri sda 
+    // external command port
+    input  logic ext_en,
+    input  logic ext_wr,
+    input  logic [2:0] ext_cmd,
+    input  logic [7:0] ext_din,
+    output logic ext_ready, ext_done_tick, ext_ack,
+    output logic [7:0] ext_dout,
+    // external signal
+    inout  tri scl,
+    inout  tri sda
    );
 
    // signal declaration
    logic [15:0] dvsr_reg;
-   logic wr_i2c, wr_dvsr;
+   logic wr_i2c, wr_dvsr, wr_cmd, rd_rx, pop_cmd;
+   logic [2:0] cmd;
+   logic [7:0] din;
    logic [7:0] dout;
-   logic ready, ack; 
-   
-   // instantiate spi controller
+   logic master_ready, ready, ack, done_tick;
+   logic [11:0] cmd_out;
+   logic cmd_empty, cmd_full;
+   logic [8:0] rx_out;
+   logic rx_empty;
+   logic log_reg;
+
+   // instantiate i2c controller
    i2c_master i2c_unit
    (
-    .din(wr_data[7:0]), .cmd(wr_data[10:8]),
-    .dvsr(dvsr_reg), .done_tick(), .*
+    .din(din), .cmd(cmd),
+    .dvsr(dvsr_reg), .ready(master_ready), .*
    );
-       
+
+   // command FIFO: {log, cmd, data}
+   fifo #(.DATA_WIDTH(12), .ADDR_WIDTH(FIFO_DEPTH_BIT)) cmd_fifo_unit
+      (.*, .rd(pop_cmd), .wr(wr_cmd), .w_data(wr_data[11:0]),
+       .empty(cmd_empty), .full(cmd_full), .r_data(cmd_out));
+
+   // read-data FIFO: {ack, data}
+   fifo #(.DATA_WIDTH(9), .ADDR_WIDTH(FIFO_DEPTH_BIT)) rx_fifo_unit
+      (.*, .rd(rd_rx), .wr(done_tick & log_reg), .w_data({ack, dout}),
+       .empty(rx_empty), .full(), .r_data(rx_out));
+
    // registers
    always_ff @(posedge clk, posedge reset)
-      if (reset)
+      if (reset) begin
         dvsr_reg <= 0;
-      else   
+        log_reg <= 1'b0;
+      end
+      else begin
          if (wr_dvsr)
              dvsr_reg <= wr_data[15:0];
+         if (pop_cmd)
+             log_reg <= cmd_out[11];
+         else if (ext_en)
+             log_reg <= 1'b0;
+      end
+   // issue next command as soon as the master can take it
+   assign pop_cmd = ~ext_en & ~cmd_empty & master_ready;
+   assign ready = cmd_empty & master_ready;
+   // command source multiplexing
+   assign wr_i2c = (ext_en) ? ext_wr : pop_cmd;
+   assign cmd = (ext_en) ? ext_cmd : cmd_out[10:8];
+   assign din = (ext_en) ? ext_din : cmd_out[7:0];
+   assign ext_ready = master_ready;
+   assign ext_done_tick = done_tick;
+   assign ext_ack = ack;
+   assign ext_dout = dout;
    // decoding
    assign wr_dvsr = cs & write & addr[1:0]==2'b01;
-   assign wr_i2c  = cs & write & addr[1:0]==2'b10;
-   // read data  
-   assign rd_data = {22'b0, ack, ready, dout};
-endmodule  
-
-
+   assign wr_cmd  = cs & write & addr[1:0]==2'b10;
+   assign rd_rx   = cs & write & addr[1:0]==2'b11;
+   // read data
+   assign rd_data = (addr[1:0]==2'b11) ?
+                    {22'b0, rx_empty, rx_out} :
+                    {20'b0, rx_empty, cmd_full, ack, ready, dout};
+endmodule
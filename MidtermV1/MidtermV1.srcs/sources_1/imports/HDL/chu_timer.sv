@@ -1,10 +1,30 @@
 //  * Reg map;
-//    * 00: read (32 LSB of counter)
-//    * 01: read (16 MSB of counter)
+//    * 00: read (32 LSB of counter; latches the 16 MSB)
+//    * 01: read (16 MSB of counter latched by the last 00 read)
 //    * 10: control register: 
 //        bit 0: go/pause
 //        bit 1: clear (no memory, just used to generate a 1-clock pulse)
+//    * 11: read/write: 32 LSB of compare value
+//    * 100: read/write: 16 MSB of compare value
+//    * 101: read/write: alarm period (# clocks; 0: one-shot)
+//    * 110: alarm control (write) / status (read):
+//        write: bit 0: arm (also clears event/miss); bit 1: irq enable
+//        read:  bit 0: armed; bit 1: irq enable; bit 2: event;
+//               bit 3: miss (match while event still set)
+//    * 111: dummy write to clear event and miss
+//    * 1000: read: 32 LSB of captured counter (latches 1001)
+//            write: capture source: bits 1-0: 0: off; 1: cap_evt[0];
+//            2: cap_evt[1] (also clears valid/overrun)
+//    * 1001: read: bits 15-0: 16 MSB of captured counter; bit 16: valid;
+//            bit 17: overrun (capture while valid) (latched by 1000 read)
+//            write: dummy write to clear valid and overrun
 //  * 48-bit counter (up to 65 days)
+//  * alarm: fires when the armed counter reaches the compare value;
+//    one-shot disarms, periodic adds the period to the compare value
+//  * irq: event & irq enable (level; cleared by 111 or re-arm;
+//    a match in the clock of the 111 write sets the event again)
+//  * capture: counter stored on the rising edge of the selected
+//    cap_evt input (synchronous to clk)
 
 module chu_timer
    (
@@ -16,14 +36,31 @@ module chu_timer
     input  logic write,
     input  logic [4:0] addr,
     input  logic [31:0] wr_data,
-    output logic [31:0] rd_data
+    output logic [31:0] rd_data,
+    // counter value for time-stamping in other cores
+    output logic [47:0] count,
+    // alarm interrupt
+    output logic irq,
+    // capture events
+    input  logic [1:0] cap_evt
    );
-   
+
    // signal declaration
    logic [47:0] count_reg;
    logic ctrl_reg;
    logic wr_en, clear, go;
-   
+   logic [47:0] cmp_reg;
+   logic [31:0] period_reg;
+   logic armed_reg, irq_en_reg, event_reg, miss_reg;
+   logic wr_cmp_lo, wr_cmp_hi, wr_period, wr_alarm, wr_ack, match;
+   logic [47:0] snap_reg;
+   logic rd_lower_reg, rd_cap_reg;
+   logic [47:0] cap_reg;
+   logic [1:0] cap_src_reg;
+   logic cap_valid_reg, cap_ovf_reg, cap_in, cap_in_reg, cap;
+   logic [49:0] cap_snap_reg;
+   logic rd_lower, rd_cap_lo, wr_cap_src, wr_cap_clr;
+
    //***************************************************************
    // counter
    //***************************************************************
@@ -35,7 +72,100 @@ module chu_timer
             count_reg <=0;
          else if (go)
             count_reg <= count_reg + 1;
-            
+
+   //***************************************************************
+   // compare/alarm
+   //***************************************************************
+   assign match = armed_reg && (count_reg >= cmp_reg);
+   always_ff @(posedge clk, posedge reset)
+      if (reset) begin
+         cmp_reg <= 0;
+         period_reg <= 0;
+         armed_reg <= 1'b0;
+         irq_en_reg <= 1'b0;
+         event_reg <= 1'b0;
+         miss_reg <= 1'b0;
+      end
+      else begin
+         if (wr_cmp_lo)
+            cmp_reg[31:0] <= wr_data;
+         else if (wr_cmp_hi)
+            cmp_reg[47:32] <= wr_data[15:0];
+         else if (match && period_reg != 0)
+            cmp_reg <= cmp_reg + period_reg;
+         if (wr_period)
+            period_reg <= wr_data;
+         if (wr_alarm) begin
+            armed_reg <= wr_data[0];
+            irq_en_reg <= wr_data[1];
+            event_reg <= 1'b0;
+            miss_reg <= 1'b0;
+         end
+         else if (match) begin
+            // a match in the clock of an ack is a new event
+            event_reg <= 1'b1;
+            miss_reg <= (wr_ack) ? 1'b0 : miss_reg | event_reg;
+            if (period_reg == 0)
+               armed_reg <= 1'b0;
+         end
+         else if (wr_ack) begin
+            event_reg <= 1'b0;
+            miss_reg <= 1'b0;
+         end
+      end
+   assign irq = event_reg & irq_en_reg;
+
+   //***************************************************************
+   // event capture
+   //***************************************************************
+   assign cap_in = (cap_src_reg==2'b01) ? cap_evt[0] :
+                   (cap_src_reg==2'b10) ? cap_evt[1] : 1'b0;
+   assign cap = cap_in & ~cap_in_reg;
+   always_ff @(posedge clk, posedge reset)
+      if (reset) begin
+         cap_reg <= 0;
+         cap_src_reg <= 2'b00;
+         cap_valid_reg <= 1'b0;
+         cap_ovf_reg <= 1'b0;
+         cap_in_reg <= 1'b0;
+      end
+      else begin
+         cap_in_reg <= cap_in;
+         if (wr_cap_src)
+            cap_src_reg <= wr_data[1:0];
+         if (cap)
+            cap_reg <= count_reg;
+         if (wr_cap_src || wr_cap_clr) begin
+            cap_valid_reg <= 1'b0;
+            cap_ovf_reg <= 1'b0;
+         end
+         else if (cap) begin
+            cap_valid_reg <= 1'b1;
+            cap_ovf_reg <= cap_ovf_reg | cap_valid_reg;
+         end
+      end
+
+   //***************************************************************
+   // snapshots at the LSB read strobe (no tearing between the two
+   // 32-bit reads); the clock after the strobe returns the LSB from
+   // the same snapshot in case the bus samples the data then
+   //***************************************************************
+   always_ff @(posedge clk, posedge reset)
+      if (reset) begin
+         snap_reg <= 0;
+         cap_snap_reg <= 0;
+         rd_lower_reg <= 1'b0;
+         rd_cap_reg <= 1'b0;
+      end
+      else begin
+         rd_lower_reg <= rd_lower;
+         rd_cap_reg <= rd_cap_lo;
+         if (rd_lower)
+            snap_reg <= count_reg;
+         if (rd_cap_lo)
+            cap_snap_reg <= {cap_ovf_reg, cap_valid_reg, cap_reg};
+      end
+
    //***************************************************************
    // wrapping circuit
    //***************************************************************
@@ -47,11 +177,30 @@ module chu_timer
          if (wr_en)
             ctrl_reg <= wr_data[0];
    // decoding logic
-   assign wr_en = write && cs && (addr[1:0]==2'b10);
+   assign wr_en = write && cs && (addr[3:0]==4'b0010);
    assign clear = wr_en && wr_data[1];
    assign go    = ctrl_reg;
+   assign count = count_reg;
+   assign wr_cmp_lo = write && cs && (addr[3:0]==4'b0011);
+   assign wr_cmp_hi = write && cs && (addr[3:0]==4'b0100);
+   assign wr_period = write && cs && (addr[3:0]==4'b0101);
+   assign wr_alarm  = write && cs && (addr[3:0]==4'b0110);
+   assign wr_ack    = write && cs && (addr[3:0]==4'b0111);
+   assign wr_cap_src = write && cs && (addr[3:0]==4'b1000);
+   assign wr_cap_clr = write && cs && (addr[3:0]==4'b1001);
+   assign rd_lower  = read && cs && (addr[3:0]==4'b0000);
+   assign rd_cap_lo = read && cs && (addr[3:0]==4'b1000);
    // slot read interface
-   assign rd_data = (addr[0]==0)?
-                    count_reg[31:0]:
-                    {16'h0000, count_reg[47:32]};
+   always_comb
+      case (addr[3:0])
+         4'b0000: rd_data = (rd_lower_reg) ? snap_reg[31:0] : count_reg[31:0];
+         4'b0001: rd_data = {16'h0000, snap_reg[47:32]};
+         4'b0011: rd_data = cmp_reg[31:0];
+         4'b0100: rd_data = {16'h0000, cmp_reg[47:32]};
+         4'b0101: rd_data = period_reg;
+         4'b0110: rd_data = {28'h0000000, miss_reg, event_reg, irq_en_reg, armed_reg};
+         4'b1000: rd_data = (rd_cap_reg) ? cap_snap_reg[31:0] : cap_reg[31:0];
+         4'b1001: rd_data = {14'h0000, cap_snap_reg[49:32]};
+         default: rd_data = count_reg[31:0];
+      endcase
 endmodule
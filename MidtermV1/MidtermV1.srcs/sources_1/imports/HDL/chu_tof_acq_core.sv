@@ -0,0 +1,275 @@
+//  * ISL29501 autonomous acquisition engine
+//  * Reg map:
+//    * write
+//      * 0: control: bit 0: enable; bit 1: clear overflow flag (1-clock pulse)
+//      * 1: sample period (# clocks between sample starts)
+//      * 2: conversion wait (# clocks from sample start to result read;
+//           counted from the end of the 0x49 write, as the time stamp)
+//      * 3: dummy write to remove a sample from head of FIFO
+//      * 4: 7-bit device address
+//    * read
+//      * 0: status:
+//           bit 0: busy (i2c master owned by the engine)
+//           bit 1: FIFO empty, bit 2: FIFO full, bit 3: overflow (sample lost)
+//           bits 15-8: # samples in FIFO
+//      * 1: time stamp of head sample (32 LSBs of system timer at sample start)
+//      * 2: head sample: bits 15-0: raw distance (0xd1/0xd2), bit 16: nack
+//  * sequence per sample (sensor in single-shot mode):
+//      start, wr dev, wr 0xb0, wr 0x49, stop                   (sample start)
+//      wait conversion
+//      start, wr dev, wr 0xd1, restart, wr dev|1, rd, rd, stop (result read)
+//  * drives the i2c master through the external port of chu_i2c_core;
+//    the cpu must not use that i2c slot while the engine is enabled
+
+module chu_tof_acq_core
+   #(parameter FIFO_DEPTH_BIT = 6)  // # addr bits of sample FIFO
+   (
+    input  logic clk,
+    input  logic reset,
+    // slot interface
+    input  logic cs,
+    input  logic read,
+    input  logic write,
+    input  logic [4:0] addr,
+    input  logic [31:0] wr_data,
+    output logic [31:0] rd_data,
+    // system timer for time stamps
+    input  logic [31:0] sys_tick,
+    // external command port of i2c core
+    output logic i2c_en,
+    output logic i2c_wr,
+    output logic [2:0] i2c_cmd,
+    output logic [7:0] i2c_din,
+    input  logic i2c_ready, i2c_done_tick, i2c_ack,
+    input  logic [7:0] i2c_dout,
+    // 1-clock pulse at the time stamp of each sample (sample start done)
+    output logic start_tick
+   );
+
+   //symbolic constant
+   localparam START_CMD   =3'b000;
+   localparam WR_CMD      =3'b001;
+   localparam RD_CMD      =3'b010;
+   localparam STOP_CMD    =3'b011;
+   localparam RESTART_CMD =3'b100;
+   localparam LAST_STEP = 12;
+   // fsm state type
+   typedef enum {idle, issue, wait_cmd, conv} state_type;
+
+   // declaration
+   state_type state_reg, state_next;
+   logic [3:0] step_reg, step_next;
+   logic [31:0] conv_cnt_reg, conv_cnt_next;
+   logic [15:0] data_reg, data_next;
+   logic nack_reg, nack_next;
+   logic [31:0] ts_reg, ts_next;
+   logic [31:0] per_cnt_reg, period_reg, conv_reg;
+   logic [6:0] dev_reg;
+   logic en_reg, ovf_reg, due_reg;
+   logic [2:0] s_cmd;
+   logic [7:0] s_din;
+   logic start_seq, push;
+   logic wr_ctrl, wr_period, wr_conv, wr_dev, rm_sample, pop;
+   logic [48:0] fifo_out;
+   logic fifo_empty, fifo_full;
+   logic [FIFO_DEPTH_BIT:0] cnt_reg;
+   logic [7:0] cnt;
+
+   // body
+   //****************************************************************
+   // sample FIFO: {nack, time stamp, raw distance}
+   //****************************************************************
+   fifo #(.DATA_WIDTH(49), .ADDR_WIDTH(FIFO_DEPTH_BIT)) fifo_unit
+      (.*, .rd(pop), .wr(push), .w_data({nack_reg, ts_reg, data_reg}),
+       .empty(fifo_empty), .full(fifo_full), .r_data(fifo_out));
+   assign pop = rm_sample & ~fifo_empty;
+
+   //****************************************************************
+   // control registers, sample period timer, FIFO count
+   //****************************************************************
+   always_ff @(posedge clk, posedge reset)
+      if (reset) begin
+         en_reg <= 1'b0;
+         ovf_reg <= 1'b0;
+         period_reg <= 32'd1_000_000;   // 10 ms
+         conv_reg <= 32'd500_000;       // 5 ms
+         dev_reg <= 7'h57;
+         per_cnt_reg <= 0;
+         due_reg <= 1'b0;
+         cnt_reg <= 0;
+      end
+      else begin
+         if (wr_ctrl)
+            en_reg <= wr_data[0];
+         if (push & fifo_full)
+            ovf_reg <= 1'b1;
+         else if (wr_ctrl & wr_data[1])
+            ovf_reg <= 1'b0;
+         if (wr_period)
+            period_reg <= wr_data;
+         if (wr_conv)
+            conv_reg <= wr_data;
+         if (wr_dev)
+            dev_reg <= wr_data[6:0];
+         // first sample right after enable, then one per period
+         if (~en_reg) begin
+            per_cnt_reg <= 0;
+            due_reg <= 1'b1;
+         end
+         else if (per_cnt_reg >= period_reg - 1) begin
+            per_cnt_reg <= 0;
+            due_reg <= 1'b1;
+         end
+         else begin
+            per_cnt_reg <= per_cnt_reg + 1;
+            if (start_seq)
+               due_reg <= 1'b0;
+         end
+         // # samples in FIFO
+         if ((push & ~fifo_full) & ~pop)
+            cnt_reg <= cnt_reg + 1;
+         else if (pop & ~(push & ~fifo_full))
+            cnt_reg <= cnt_reg - 1;
+      end
+
+   //****************************************************************
+   // i2c command sequence
+   //****************************************************************
+   always_comb
+   begin
+      s_din = 8'h00;
+      case (step_reg)
+         0, 5:  s_cmd = START_CMD;
+         1, 6: begin
+            s_cmd = WR_CMD;
+            s_din = {dev_reg, 1'b0};
+         end
+         2: begin
+            s_cmd = WR_CMD;
+            s_din = 8'hb0;       // command register
+         end
+         3: begin
+            s_cmd = WR_CMD;
+            s_din = 8'h49;       // sample start
+         end
+         7: begin
+            s_cmd = WR_CMD;
+            s_din = 8'hd1;       // distance msb; lsb follows
+         end
+         8:     s_cmd = RESTART_CMD;
+         9: begin
+            s_cmd = WR_CMD;
+            s_din = {dev_reg, 1'b1};
+         end
+         10:    s_cmd = RD_CMD;  // ack
+         11: begin
+            s_cmd = RD_CMD;
+            s_din = 8'h01;       // nack last byte
+         end
+         default: s_cmd = STOP_CMD; // 4, 12
+      endcase
+   end
+
+   // registers
+   always_ff @(posedge clk, posedge reset)
+      if (reset) begin
+         state_reg <= idle;
+         step_reg <= 0;
+         conv_cnt_reg <= 0;
+         data_reg <= 0;
+         nack_reg <= 1'b0;
+         ts_reg <= 0;
+      end
+      else begin
+         state_reg <= state_next;
+         step_reg <= step_next;
+         conv_cnt_reg <= conv_cnt_next;
+         data_reg <= data_next;
+         nack_reg <= nack_next;
+         ts_reg <= ts_next;
+      end
+
+   // next-state logic
+   always_comb
+   begin
+      state_next = state_reg;
+      step_next = step_reg;
+      // clocks since the sample start (cleared at the step-3 done tick)
+      conv_cnt_next = (state_reg==idle) ? conv_cnt_reg : conv_cnt_reg + 1;
+      data_next = data_reg;
+      nack_next = nack_reg;
+      ts_next = ts_reg;
+      start_seq = 1'b0;
+      push = 1'b0;
+      i2c_wr = 1'b0;
+      case (state_reg)
+         idle:
+            if (en_reg && due_reg && i2c_ready) begin
+               start_seq = 1'b1;
+               step_next = 0;
+               nack_next = 1'b0;
+               state_next = issue;
+            end
+         issue:
+            if (i2c_ready) begin
+               i2c_wr = 1'b1;
+               state_next = wait_cmd;
+            end
+         wait_cmd: begin
+            if (i2c_done_tick) begin
+               if (s_cmd==WR_CMD && i2c_ack)
+                  nack_next = 1'b1;
+               if (step_reg==3) begin
+                  ts_next = sys_tick;
+                  conv_cnt_next = 0;
+               end
+               if (step_reg==10)
+                  data_next[15:8] = i2c_dout;
+               if (step_reg==11)
+                  data_next[7:0] = i2c_dout;
+            end
+            if (i2c_ready)
+               if (step_reg==4)
+                  state_next = conv;
+               else if (step_reg==LAST_STEP) begin
+                  push = 1'b1;
+                  state_next = idle;
+               end
+               else begin
+                  step_next = step_reg + 1;
+                  state_next = issue;
+               end
+         end
+         default: begin   // conv: wait for conversion
+            if (conv_cnt_reg >= conv_reg) begin
+               step_next = 5;
+               state_next = issue;
+            end
+         end
+      endcase
+   end
+   // i2c master owned while enabled and until the current sample completes
+   assign i2c_en = en_reg || (state_reg != idle);
+   assign start_tick = (state_reg==wait_cmd) && i2c_done_tick && (step_reg==3);
+   assign i2c_cmd = s_cmd;
+   assign i2c_din = s_din;
+
+   //****************************************************************
+   // wrapping circuit
+   //****************************************************************
+   // decoding logic
+   assign wr_ctrl   = cs && write && (addr[2:0]==3'b000);
+   assign wr_period = cs && write && (addr[2:0]==3'b001);
+   assign wr_conv   = cs && write && (addr[2:0]==3'b010);
+   assign rm_sample = cs && write && (addr[2:0]==3'b011);
+   assign wr_dev    = cs && write && (addr[2:0]==3'b100);
+   // slot read interface
+   assign cnt = cnt_reg;
+   always_comb
+      case (addr[1:0])
+         2'b00:   rd_data = {16'h0000, cnt, 4'h0, ovf_reg, fifo_full, fifo_empty, i2c_en};
+         2'b01:   rd_data = fifo_out[47:16];
+         2'b10:   rd_data = {15'h0000, fifo_out[48], fifo_out[15:0]};
+         default: rd_data = 32'h0000_0000;
+      endcase
+endmodule
@@ -2,7 +2,9 @@
 // * Limitation
 //     * only function as I2C master
 //     * no arbitration (i.e., no other master allowed)
-//     * do not support salve "clock-stretching"
+//     * slave "clock-stretching" supported: the master releases scl
+//       and holds its timer while the line is kept low by a slave;
+//       each high phase is counted from the (synchronized) rising edge
 // * Input
 //     cmd (command):  000:start, 001:write, 010:read, 011:stop, 100:restart
 //     din: write:8-bit data;  read:LSB is ack/nack bit used in read
@@ -22,6 +24,11 @@
 //          * data into sdat: loops 0-7 of read and loop 8 of write (receive ack)
 //    * dvsr: divisor to obtain a quarter of i2c clock period 
 //          *  0.5*(# clk in SCK period) 
+//          * scl low/high = 2*dvsr clocks each (plus sync delay on high)
+//          * fast mode (400K, tLOW >= 1.3 us):   dvsr >= 65 @ 100 MHz
+//          * fast mode plus (1M, tLOW >= 0.5 us): dvsr >= 25 @ 100 MHz
+//          * tHD;STA/tSU;STO/tBUF are 2*dvsr; data changes dvsr after
+//            scl falls (hold) and dvsr before it rises (setup)
 //         
 // during a read operation, the LSB of din is the NACK bit
 // i.e., indicate whether the current read is the last one in read cycle
@@ -33,7 +40,7 @@ module i2c_master(
    input  logic [15:0] dvsr,  
    input  logic [2:0] cmd, 
    input  logic wr_i2c,
-   output tri scl,
+   inout  tri scl,
    inout  tri sda,
    output logic ready, done_tick, ack,
    output logic [7:0] dout
@@ -62,6 +69,8 @@ module i2c_master(
    logic sda_out, scl_out, sda_reg, scl_reg, data_phase;
    logic done_tick_i, ready_i;
    logic into, nack ;
+   logic [1:0] scl_sync_reg;
+   logic stretch;
 
    // body
    //****************************************************************
@@ -77,8 +86,16 @@ module i2c_master(
          sda_reg <= sda_out;
          scl_reg <= scl_out;
       end
-   // only master drives scl line  
+   // master drives scl low only; slave may hold it low (stretching)
    assign scl = (scl_reg) ? 1'bz : 1'b0;
+   // synchronizer for scl line
+   always_ff @(posedge clk, posedge reset)
+      if (reset)
+         scl_sync_reg <= 2'b11;
+      else
+         scl_sync_reg <= {scl_sync_reg[0], scl};
+   // scl released by master but still low: hold the timer
+   assign stretch = scl_reg & ~scl_sync_reg[1];
    // sda are with pull-up resistors and becomes high when not driven
    // "into" signal asserted when sdat into master
    assign into = (data_phase && cmd_reg==RD_CMD && bit_reg<8) ||  
@@ -117,7 +134,7 @@ module i2c_master(
    always_comb
    begin
       state_next = state_reg;
-      c_next = c_reg + 1;     // timer counts continuousely 
+      c_next = (stretch) ? c_reg : c_reg + 1;  // timer counts unless stretched
       bit_next = bit_reg;
       tx_next = tx_reg;
       rx_next = rx_reg;
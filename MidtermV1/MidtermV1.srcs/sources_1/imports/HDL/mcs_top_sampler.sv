@@ -23,10 +23,10 @@ module mcs_top_sampler
    input  logic acl_miso,
    output logic acl_ss_n,
    // i2c temperature sensor  
-   output logic tmp_i2c_scl,
+   inout  tri tmp_i2c_scl,
    inout  tri tmp_i2c_sda,
    // i2c tof sensor  
-   output logic tof_i2c_scl,
+   inout  tri tof_i2c_scl,
    inout  tri tof_i2c_sda,
    // ps2
    inout  tri ps2d,
@@ -36,8 +36,9 @@ module mcs_top_sampler
    // PMOD JA (divided into top row and bottom row)
    output logic [4:1] ja_top,
    output logic [10:7] ja_btm,
-   //PMOD JB 
-   output logic [2:1] jb_top,
+   //PMOD JB (tof sensor: irq on pin 1, sample start on pin 2)
+   input  logic tof_irq_n,
+   output logic tof_ss_n,
    output logic [10:7] jb_btm
 );
 
@@ -53,6 +54,9 @@ module mcs_top_sampler
    logic [31:0] io_write_data;
    logic [31:0] io_read_data;
    logic io_ready;
+   // MCS external interrupt
+   logic [1:0] intc_interrupt;
+   logic timer_irq;
    // fpro bus 
    logic fp_mmio_cs; 
    logic fp_wr;      
@@ -80,8 +84,12 @@ module mcs_top_sampler
    assign ja_top[4:3] = pwm[7:6];
    assign ja_btm = 4'b0000;
    // PMOD JB (UNUSED PINS ON TOF)...
-   assign jb_top[1] = 1'b1; //Keep high, not using IRQ...
-   assign jb_top[2] = 1'b1; //Keep high, we're controlling in software...
+   assign tof_ss_n = 1'b1; //Keep high, we're controlling in software...
+   // ToF data-ready irq (active low) -> MCS external interrupt 0
+   // (rising edge of inverted line; synchronized inside the IO module)
+   assign intc_interrupt[0] = ~tof_irq_n;
+   // system timer alarm -> MCS external interrupt 1
+   assign intc_interrupt[1] = timer_irq;
    assign jb_btm = 4'b1100;
    //instantiate uBlaze MCS
    cpu cpu_unit (
@@ -94,7 +102,8 @@ module mcs_top_sampler
     .IO_read_strobe(io_read_strobe),    
     .IO_ready(io_ready),                
     .IO_write_data(io_write_data),      
-    .IO_write_strobe(io_write_strobe)   
+    .IO_write_strobe(io_write_strobe),  
+    .INTC_Interrupt(intc_interrupt)
     );
     
    // instantiate bridge
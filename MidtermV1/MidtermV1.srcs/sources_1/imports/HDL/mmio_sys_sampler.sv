@@ -36,14 +36,18 @@ module mmio_sys_sampler
    input  logic acl_miso,
    output logic acl_ss,
    // i2c temperature sensor  
-   output logic tmp_i2c_scl,
+   inout  tri tmp_i2c_scl,
    inout  tri tmp_i2c_sda,
    // i2c tof sensor  
-   output logic tof_i2c_scl,
+   inout  tri tof_i2c_scl,
    inout  tri tof_i2c_sda,
    // ps2
    inout  tri ps2d,
    inout  tri ps2c,
+   // system timer alarm interrupt
+   output logic timer_irq,
+   // ToF data-ready irq (active low; captured by the system timer)
+   input  logic tof_irq_n,
    // ddfs square wave output
    output  logic  ddfs_sq_wave,
    // 1-bit dac 
@@ -58,8 +62,21 @@ module mmio_sys_sampler
    logic [31:0] rd_data_array [63:0]; 
    logic [31:0] wr_data_array [63:0];
    logic [15:0] adsr_env;
+   logic [47:0] sys_tick;
+   logic acq_en, acq_wr, acq_ready, acq_done_tick, acq_ack;
+   logic [2:0] acq_cmd;
+   logic [7:0] acq_din, acq_dout;
+   logic acq_start_tick;
+   logic [1:0] tof_irq_sync;
 
    // body
+   // ToF irq synchronizer for the timer capture (asserted = 1)
+   always_ff @(posedge clk, posedge reset)
+      if (reset)
+         tof_irq_sync <= 2'b00;
+      else
+         tof_irq_sync <= {tof_irq_sync[0], ~tof_irq_n};
+
    // instantiate mmio controller 
    chu_mmio_controller ctrl_unit
    (.clk(clk),
@@ -88,7 +105,10 @@ module mmio_sys_sampler
     .write(mem_wr_array[`S0_SYS_TIMER]),
     .addr(reg_addr_array[`S0_SYS_TIMER]),
     .rd_data(rd_data_array[`S0_SYS_TIMER]),
-    .wr_data(wr_data_array[`S0_SYS_TIMER])
+    .wr_data(wr_data_array[`S0_SYS_TIMER]),
+    .count(sys_tick),
+    .irq(timer_irq),
+    .cap_evt({acq_start_tick, tof_irq_sync[1]})
     );
 
    // slot 1: UART 
@@ -141,6 +161,14 @@ module mmio_sys_sampler
      .addr(reg_addr_array[`S4_USER]),
      .rd_data(rd_data_array[`S4_USER]),
      .wr_data(wr_data_array[`S4_USER]),
+     .ext_en(acq_en),
+     .ext_wr(acq_wr),
+     .ext_cmd(acq_cmd),
+     .ext_din(acq_din),
+     .ext_ready(acq_ready),
+     .ext_done_tick(acq_done_tick),
+     .ext_ack(acq_ack),
+     .ext_dout(acq_dout),
      .scl(tof_i2c_scl),
      .sda(tof_i2c_sda)
      );
@@ -225,6 +253,14 @@ module mmio_sys_sampler
      .addr(reg_addr_array[`S10_I2C]),
      .rd_data(rd_data_array[`S10_I2C]),
      .wr_data(wr_data_array[`S10_I2C]),
+     .ext_en(1'b0),
+     .ext_wr(1'b0),
+     .ext_cmd(3'b000),
+     .ext_din(8'h00),
+     .ext_ready(),
+     .ext_done_tick(),
+     .ext_ack(),
+     .ext_dout(),
      .scl(tmp_i2c_scl),
      .sda(tmp_i2c_sda)
      );
@@ -274,10 +310,32 @@ module mmio_sys_sampler
     .adsr_env(adsr_env)
     );
 
+   // slot 14: ToF acquisition engine (drives i2c master of slot 4)
+   chu_tof_acq_core tof_acq_slot14
+   (.clk(clk),
+    .reset(reset),
+    .cs(cs_array[`S14_TOF_ACQ]),
+    .read(mem_rd_array[`S14_TOF_ACQ]),
+    .write(mem_wr_array[`S14_TOF_ACQ]),
+    .addr(reg_addr_array[`S14_TOF_ACQ]),
+    .rd_data(rd_data_array[`S14_TOF_ACQ]),
+    .wr_data(wr_data_array[`S14_TOF_ACQ]),
+    .sys_tick(sys_tick[31:0]),
+    .i2c_en(acq_en),
+    .i2c_wr(acq_wr),
+    .i2c_cmd(acq_cmd),
+    .i2c_din(acq_din),
+    .i2c_ready(acq_ready),
+    .i2c_done_tick(acq_done_tick),
+    .i2c_ack(acq_ack),
+    .i2c_dout(acq_dout),
+    .start_tick(acq_start_tick)
+    );
+
    // assign 0's to all unused slot rd_data signals
    generate
       genvar i;
-      for (i=14; i<64; i=i+1) begin
+      for (i=15; i<64; i=i+1) begin
          assign rd_data_array[i] = 32'h0;
       end
    endgenerate
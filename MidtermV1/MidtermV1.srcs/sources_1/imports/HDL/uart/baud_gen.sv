@@ -1,16 +1,20 @@
-// baud rate generater (divisor) 
-// divided by (dvsr+1)
-// Listing 12.1
+// baud rate generater (phase accumulator)
+// tick rate = clk * inc / 2^24 (carry out of a 24-bit accumulator)
+//   * e.g., 16*921600 baud from 100 MHz: inc = 2473901, error < 1 ppm
+//   * ticks are spaced floor or ceil of clk/tick rate clocks; the
+//     average rate is exact to 1/2^24 of clk
+//   * inc must be less than 2^24 (tick rate below clk)
+// Listing 12.1 (modified)
 module baud_gen
    (
     input  logic clk, reset,
-    input  logic [10:0] dvsr,
+    input  logic [23:0] inc,
     output logic tick
    );
 
    // declaration
-   logic [10:0] r_reg;
-   logic [10:0] r_next;
+   logic [23:0] r_reg;
+   logic [24:0] r_next;
 
    // body
    // register
@@ -18,10 +22,10 @@ module baud_gen
       if (reset)
          r_reg <= 0;
       else
-         r_reg <= r_next;
+         r_reg <= r_next[23:0];
 
    // next-state logic
-   assign r_next = (r_reg==dvsr) ? 0 : r_reg + 1;
-   // output logic
-   assign tick = (r_reg==1);
-endmodule
\ No newline at end of file
+   assign r_next = {1'b0, r_reg} + {1'b0, inc};
+   // output logic: carry out
+   assign tick = r_next[24];
+endmodule
@@ -1,7 +1,10 @@
 // 
 //  Reg map (each port uses 4 address space)
 //    * 0: read data and status
-//    * 1: write baud rate 
+//         bits 7-0: rx data, bit 8: rx FIFO empty, bit 9: tx FIFO full
+//         bits 31-16: # free entries of tx FIFO
+//    * 1: write baud rate increment (bits 23-0)
+//         tick rate (16x baud) = clk * inc / 2^24
 //    * 2: write data 
 //    * 3: dummy write to remove data from head of rx FIFO 
 //
@@ -22,29 +25,32 @@ module chu_uart
    );
 
    // signal declaration
-   logic wr_uart, rd_uart, wr_dvsr ;
+   logic wr_uart, rd_uart, wr_inc ;
    logic tx_full, rx_empty;
-   logic [10:0] dvsr_reg;
+   logic [23:0] inc_reg;
    logic [7:0] r_data;
+   logic [FIFO_DEPTH_BIT:0] tx_free;
+   logic [15:0] tx_free_ext;
    logic ctrl_reg;
 
    // body
    // instantiate uart
    uart #(.DBIT(8), .SB_TICK(16), .FIFO_W(FIFO_DEPTH_BIT)) uart_unit    
-   (.*, .dvsr(dvsr_reg), .w_data(wr_data[7:0]) );
+   (.*, .inc(inc_reg), .w_data(wr_data[7:0]) );
    
-   // dvsr register
+   // baud rate increment register
    always_ff @(posedge clk, posedge reset)
       if (reset)
-         dvsr_reg <= 0;
+         inc_reg <= 0;
       else   
-         if (wr_dvsr)
-            dvsr_reg <= wr_data[10:0];
+         if (wr_inc)
+            inc_reg <= wr_data[23:0];
    // decoding logic
-   assign wr_dvsr = (write && cs && (addr[1:0]==2'b01));
+   assign wr_inc  = (write && cs && (addr[1:0]==2'b01));
    assign wr_uart = (write && cs && (addr[1:0]==2'b10));
    assign rd_uart = (write && cs && (addr[1:0]==2'b11));
    // slot read interface
-   assign rd_data = {22'h000000, tx_full,  rx_empty, r_data};
+   assign tx_free_ext = tx_free;
+   assign rd_data = {tx_free_ext, 6'h00, tx_full,  rx_empty, r_data};
 endmodule
 
@@ -8,15 +8,17 @@ module uart
     input logic clk, reset,
     input logic rd_uart, wr_uart, rx,
     input logic [7:0] w_data,
-    input logic [10:0] dvsr,
+    input logic [23:0] inc,
     output logic tx_full, rx_empty, tx,
-    output logic [7:0] r_data
+    output logic [7:0] r_data,
+    output logic [FIFO_W:0] tx_free     // # free entries of tx FIFO
    );
 
    // signal declaration
    logic tick, rx_done_s_tick, tx_done_tick;
    logic tx_empty, tx_fifo_not_empty;
    logic [7:0] tx_fifo_out, rx_data_out;
+   logic [FIFO_W:0] tx_cnt_reg;
 
    //body
    baud_gen baud_gen_unit (.*);
@@ -36,5 +38,17 @@ module uart
        .full(tx_full), .r_data(tx_fifo_out));
 
    assign tx_fifo_not_empty = ~tx_empty;
+
+   // # entries of tx FIFO; follows the FIFO's own push/pop rules
+   always_ff @(posedge clk, posedge reset)
+      if (reset)
+         tx_cnt_reg <= 0;
+      else
+         case ({wr_uart, tx_done_tick})
+            2'b10:   if (~tx_full)  tx_cnt_reg <= tx_cnt_reg + 1;
+            2'b01:   if (~tx_empty) tx_cnt_reg <= tx_cnt_reg - 1;
+            default: ;  // none, or push and pop together
+         endcase
+   assign tx_free = (1 << FIFO_W) - tx_cnt_reg;
 endmodule
 
@@ -0,0 +1,337 @@
+/*****************************************************************//**
+ * @file cosim.cpp
+ *
+ * @brief MCS io bus model, i2c pin-level slave and uart tx decoder
+ *        around the Verilator model of tb_cosim
+ *
+ *********************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "Vtb_cosim.h"
+#include "verilated.h"
+#include "vendor_io.h"
+#include "emu.h"
+#include "cosim.h"
+#include "chu_io_rw.h"
+#include "chu_io_map.h"
+
+/**********************************************************************
+ * i2c slave on the pins of the ToF bus
+ *  - start/stop detected while scl is high
+ *  - bits sampled on the scl rising edge; sda changed after the
+ *    falling edge (acks and read data)
+ *  - each byte is handed to/taken from the addressed EmuI2cDevice
+ *********************************************************************/
+class PinSlave {
+public:
+   EmuI2cDevice *dev[128];
+   int sda_low;             // output: pull sda low
+   PinSlave();
+   void step(int scl, int sda);
+private:
+   enum { IDLE, ADDR, WDATA, RDATA };
+   int state;
+   int bit;                 // # bits of the current byte done
+   int ack_phase;           // in the 9th (ack) clock
+   int rd;                  // direction of the current transfer
+   int master_ack;          // master acked the last read byte
+   uint8_t shift;
+   EmuI2cDevice *cur;
+   int scl_d, sda_d;
+   void rise(int sda);
+   void fall();
+};
+
+PinSlave::PinSlave() {
+   for (int i = 0; i < 128; i++)
+      dev[i] = 0;
+   sda_low = 0;
+   state = IDLE;
+   bit = ack_phase = rd = master_ack = 0;
+   shift = 0;
+   cur = 0;
+   scl_d = sda_d = 1;
+}
+
+void PinSlave::step(int scl, int sda) {
+   if (scl && scl_d && sda_d && !sda) {           // start/restart
+      state = ADDR;
+      bit = ack_phase = 0;
+      shift = 0;
+      sda_low = 0;
+   } else if (scl && scl_d && !sda_d && sda) {    // stop
+      if (cur)
+         cur->stop();
+      cur = 0;
+      state = IDLE;
+      sda_low = 0;
+   } else if (scl && !scl_d) {
+      rise(sda);
+   } else if (!scl && scl_d) {
+      fall();
+   }
+   scl_d = scl;
+   sda_d = sda;
+}
+
+void PinSlave::rise(int sda) {
+   if (state == IDLE)
+      return;
+   if (ack_phase) {
+      if (state == RDATA)
+         master_ack = !sda;
+      return;
+   }
+   if (state != RDATA)
+      shift = (shift << 1) | (sda & 0x01);
+   bit++;
+}
+
+void PinSlave::fall() {
+   if (state == IDLE)
+      return;
+   if (!ack_phase && bit == 8) {
+      // end of byte: drive the ack clock
+      ack_phase = 1;
+      if (state == ADDR) {
+         rd = shift & 0x01;
+         cur = dev[shift >> 1];
+         sda_low = (cur && cur->start(rd) == 0);
+         if (!sda_low)
+            state = IDLE;               // not addressed/nack; wait for start
+      } else if (state == WDATA) {
+         sda_low = (cur->write(shift) == 0);
+      } else {
+         sda_low = 0;                   // master acks the read byte
+      }
+   } else if (ack_phase) {
+      // end of ack clock: next byte
+      ack_phase = 0;
+      bit = 0;
+      if (state == ADDR)
+         state = (rd) ? RDATA : WDATA;
+      else if (state == RDATA && !master_ack) {
+         state = IDLE;
+         sda_low = 0;
+         return;
+      }
+      if (state == RDATA) {
+         shift = cur->read(0);
+         sda_low = !(shift & 0x80);
+      } else {
+         shift = 0;
+         sda_low = 0;
+      }
+   } else if (state == RDATA) {
+      sda_low = !((shift << bit) & 0x80);
+   }
+}
+
+/**********************************************************************
+ * co-simulation
+ *********************************************************************/
+struct Cosim {
+   Vtb_cosim *top;
+   uint64_t cycle;
+   uint64_t accesses;
+   int io_cycles;
+   PinSlave tof_bus;
+   std::vector<EmuI2cDevice *> devs;
+   int irq[8];
+   // uart tx decoder
+   double bit_clks;         // clocks per bit (from the baud increment)
+   int rx_busy;
+   double rx_start;
+   int rx_bit;
+   uint8_t rx_shift;
+   std::string uart_text;
+   Cosim();
+   void tick();
+   void idle(uint64_t n);
+   uint32_t access(uint32_t addr, uint32_t data, int wr);
+   void uart_step();
+};
+
+static Cosim &cosim() {
+   static Cosim *c = 0;
+
+   // created on the first access (driver globals run io_write() from
+   // static constructors)
+   if (c == 0)
+      c = new Cosim;
+   return *c;
+}
+
+Cosim::Cosim() {
+   const char *env;
+
+   env = getenv("COSIM_IO_CYCLES");
+   io_cycles = (env) ? atoi(env) : COSIM_IO_CYCLES;
+   if (io_cycles < 1)
+      io_cycles = 1;
+   for (int i = 0; i < 8; i++)
+      irq[i] = 0;
+   bit_clks = 0.0;
+   rx_busy = 0;
+   rx_start = 0.0;
+   rx_bit = 0;
+   rx_shift = 0;
+   top = new Vtb_cosim;
+   top->io_addr_strobe = 0;
+   top->io_read_strobe = 0;
+   top->io_write_strobe = 0;
+   top->io_byte_enable = 0;
+   top->io_address = 0;
+   top->io_write_data = 0;
+   top->sw = 0;
+   top->btn = 0;
+   top->rx = 1;
+   top->tof_sda_low = 0;
+   top->tof_irq_n = 1;
+   top->reset = 1;
+   cycle = 0;
+   for (int i = 0; i < 4; i++)
+      tick();
+   top->reset = 0;
+   cycle = 0;
+   accesses = 0;
+}
+
+/* one system clock */
+void Cosim::tick() {
+   top->tof_irq_n = !irq[0];
+   top->clk = 0;
+   top->eval();
+   top->clk = 1;
+   top->eval();
+   cycle++;
+   for (size_t i = 0; i < devs.size(); i++)
+      devs[i]->tick(cycle);
+   tof_bus.step(top->tof_scl_o, top->tof_sda_o);
+   top->tof_sda_low = tof_bus.sda_low;
+   irq[1] = top->timer_irq;
+   uart_step();
+}
+
+void Cosim::idle(uint64_t n) {
+   for (uint64_t i = 0; i < n; i++)
+      tick();
+}
+
+/* one io bus cycle: strobe for 1 clock, data sampled before the edge */
+uint32_t Cosim::access(uint32_t addr, uint32_t data, int wr) {
+   uint32_t rd_data = 0;
+   int bridge = ((addr >> 24) == (BRIDGE_BASE >> 24));
+
+   accesses++;
+   if (bridge) {
+      // snoop the uart baud increment for the tx decoder
+      if (wr && addr == get_slot_addr(BRIDGE_BASE, S1_UART1) + 4 && data != 0)
+         bit_clks = 16.0 * 16777216.0 / (double) (data & 0xffffff);
+      top->io_address = addr;
+      top->io_write_data = data;
+      top->io_byte_enable = 0xf;
+      top->io_addr_strobe = 1;
+      top->io_read_strobe = !wr;
+      top->io_write_strobe = wr;
+      top->eval();
+      rd_data = top->io_read_data;
+      tick();
+      top->io_addr_strobe = 0;
+      top->io_read_strobe = 0;
+      top->io_write_strobe = 0;
+      idle(io_cycles - 1);
+   } else {
+      idle(io_cycles);
+   }
+   return rd_data;
+}
+
+/* 8N1 decoder; samples in the middle of each bit */
+void Cosim::uart_step() {
+   double t = (double) cycle;
+
+   if (bit_clks == 0.0)
+      return;
+   if (!rx_busy) {
+      if (!top->tx) {
+         rx_busy = 1;
+         rx_start = t;
+         rx_bit = 0;
+         rx_shift = 0;
+      }
+      return;
+   }
+   if (t < rx_start + bit_clks * (1.5 + rx_bit))
+      return;
+   if (rx_bit < 8) {
+      rx_shift |= (top->tx & 0x01) << rx_bit;
+      rx_bit++;
+   } else {
+      if (top->tx)                     // stop bit; framing errors dropped
+         uart_text.push_back((char) rx_shift);
+      rx_busy = 0;
+   }
+}
+
+/**********************************************************************
+ * vendor_io.h / emu.h / cosim.h interface
+ *********************************************************************/
+uint32_t emu_read(uint32_t addr) {
+   return cosim().access(addr, 0, 0);
+}
+
+void emu_write(uint32_t addr, uint32_t data) {
+   cosim().access(addr, data, 1);
+}
+
+uint64_t emu_now() {
+   return cosim().cycle;
+}
+
+void emu_idle(uint64_t cycles) {
+   cosim().idle(cycles);
+}
+
+void emu_attach_slot(int slot, EmuSlot *model) {
+   fprintf(stderr, "cosim: slot %d is HDL; model not attached\n", slot);
+}
+
+void emu_attach_i2c(int slot, uint8_t addr, EmuI2cDevice *dev) {
+   Cosim &c = cosim();
+
+   if (slot != S4_USER) {
+      fprintf(stderr, "cosim: only the ToF bus (slot %d) has a slave\n",
+            S4_USER);
+      return;
+   }
+   c.tof_bus.dev[addr & 0x7f] = dev;
+   c.devs.push_back(dev);
+}
+
+void emu_irq(int line, int level) {
+   if (line >= 0 && line < 8)
+      cosim().irq[line] = level;
+}
+
+uint64_t cosim_cycles() {
+   return cosim().cycle;
+}
+
+uint64_t cosim_accesses() {
+   return cosim().accesses;
+}
+
+void cosim_idle(uint64_t cycles) {
+   cosim().idle(cycles);
+}
+
+int cosim_irq(int line) {
+   return (line >= 0 && line < 8) ? cosim().irq[line] : 0;
+}
+
+const std::string &cosim_uart_text() {
+   return cosim().uart_text;
+}
@@ -0,0 +1,66 @@
+/*****************************************************************//**
+ * @file cosim.h
+ *
+ * @brief bus-functional model of the MCS io bus for the Verilator
+ *        co-simulation of chu_mcs_bridge + mmio_sys_sampler
+ *
+ * Description:
+ * - the firmware drivers are compiled with _VENDOR_IO_ACCESS_USED and
+ *   the host vendor_io.h; io_read()/io_write() become emu_read()/
+ *   emu_write(), which this model turns into io bus cycles on tb_cosim
+ * - one access: 1 strobe clock (io_ready is tied to 1 in the bridge)
+ *   plus COSIM_IO_CYCLES-1 idle clocks for the MCS bus latency and the
+ *   driver instructions around it; cycle counts are exact for the HDL
+ *   under that cpu timing assumption (the MCS is not simulated)
+ * - accesses outside the bridge (io module at IOMODULE_BASE) read 0
+ *   and only cost the access clocks
+ * - the ToF i2c bus (slot 4) has a pin-level slave that serves the
+ *   EmuI2cDevice models of emu_devices.h (emu_attach_i2c())
+ * - the uart tx pin is decoded at the baud rate written by the driver
+ * - environment:
+ *     COSIM_IO_CYCLES: clocks per MMIO access (default 8)
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _COSIM_H_INCLUDED
+#define _COSIM_H_INCLUDED
+
+#include <stdint.h>
+#include <string>
+
+#define COSIM_IO_CYCLES 8      // default clocks per MMIO access
+
+/**
+ * # system clocks since the end of reset
+ *
+ */
+uint64_t cosim_cycles();
+
+/**
+ * # MMIO accesses since the end of reset
+ *
+ */
+uint64_t cosim_accesses();
+
+/**
+ * let clocks pass without an access
+ *
+ * @param cycles # clocks
+ */
+void cosim_idle(uint64_t cycles);
+
+/**
+ * level of an MCS external interrupt input (device model or HDL)
+ *
+ * @param line input number (0: ToF data ready, 1: timer alarm)
+ */
+int cosim_irq(int line);
+
+/**
+ * text decoded from the uart tx pin so far
+ *
+ */
+const std::string &cosim_uart_text();
+
+#endif  // _COSIM_H_INCLUDED
@@ -0,0 +1,291 @@
+/*****************************************************************//**
+ * @file cosim_bench.cpp
+ *
+ * @brief clock cycles per driver call and per ToF sample on the
+ *        Verilator model of chu_mcs_bridge + mmio_sys_sampler
+ *
+ * Description:
+ * - the unmodified drivers (TimerCore, UartCore, SsegCore, GpoCore,
+ *   I2cCore, Isl29501, TofAcqCore) run against the HDL through the
+ *   io bus model of cosim.cpp
+ * - timer alarm: sleep() and the irq period of a periodic alarm
+ * - each measured call reports min/avg/max system clocks and the
+ *   # MMIO accesses it made
+ * - ToF samples:
+ *   - single shot, data ready polled in 0x69 (i2c)
+ *   - single shot, data ready from the irq line
+ *   - acquisition engine (slot 14): sample period from the time stamps
+ *     and cpu clocks per sample to empty the FIFO
+ * - functional checks: device id, uart text on the tx pin, sample
+ *   values, timer capture of the irq edge and of the engine sample
+ *   start; exit status 1 on failure
+ *
+ *********************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "verilated.h"
+#include "cosim.h"
+#include "emu_devices.h"
+#include "chu_init.h"
+#include "gpio_cores.h"
+#include "sseg_core.h"
+#include "i2c_core.h"
+#include "isl29501.h"
+#include "tof_acq_core.h"
+#include "num_fmt.h"
+
+static const uint8_t TOF_DEV = 0x57;
+
+/* statistics of one measured call */
+struct Stat {
+   const char *name;
+   uint64_t n, sum, min, max, io;
+};
+
+static Stat stats[64];
+static int n_stats;
+static int fails;
+
+static Stat *stat_of(const char *name) {
+   for (int i = 0; i < n_stats; i++)
+      if (strcmp(stats[i].name, name) == 0)
+         return &stats[i];
+   Stat *s = &stats[n_stats++];
+   s->name = name;
+   s->n = s->sum = s->max = s->io = 0;
+   s->min = ~0ULL;
+   return s;
+}
+
+static void record(const char *name, uint64_t cycles, uint64_t io) {
+   Stat *s = stat_of(name);
+
+   s->n++;
+   s->sum += cycles;
+   s->io += io;
+   if (cycles < s->min)
+      s->min = cycles;
+   if (cycles > s->max)
+      s->max = cycles;
+}
+
+/* run stmt once and record its clocks and accesses under name */
+#define MEASURE(name, stmt) do { \
+      uint64_t t0_ = cosim_cycles(), a0_ = cosim_accesses(); \
+      stmt; \
+      record((name), cosim_cycles() - t0_, cosim_accesses() - a0_); \
+   } while (0)
+
+static void check(int ok, const char *what) {
+   if (!ok) {
+      printf("FAIL: %s\n", what);
+      fails++;
+   }
+}
+
+static void report() {
+   printf("%-34s %5s %9s %9s %9s %6s %9s\n", "call", "n", "min clk",
+         "avg clk", "max clk", "io", "avg us");
+   for (int i = 0; i < n_stats; i++) {
+      Stat *s = &stats[i];
+      if (s->n == 0)
+         continue;
+      double avg = (double) s->sum / s->n;
+      printf("%-34s %5llu %9llu %9.0f %9llu %6.1f %9.2f\n", s->name,
+            (unsigned long long) s->n, (unsigned long long) s->min, avg,
+            (unsigned long long) s->max, (double) s->io / s->n,
+            avg / SYS_CLK_FREQ);
+   }
+}
+
+/**********************************************************************
+ * driver calls
+ *********************************************************************/
+static void bench_timer_gpio() {
+   TimerCore timer(get_slot_addr(BRIDGE_BASE, S0_SYS_TIMER));
+   GpoCore led(get_slot_addr(BRIDGE_BASE, S2_LED));
+   SsegCore sseg(get_slot_addr(BRIDGE_BASE, S8_SSEG));
+   uint8_t ptn[8];
+   uint64_t t0 = 0, t1 = 0;
+
+   for (int i = 0; i < 16; i++) {
+      MEASURE("TimerCore::read_tick", t0 = timer.read_tick());
+      MEASURE("TimerCore::read_time", timer.read_time());
+      MEASURE("now_us", now_us());
+      MEASURE("GpoCore::write", led.write(i));
+      MEASURE("SsegCore::write_1ptn", sseg.write_1ptn(sseg.h2s(i), i & 7));
+      for (int k = 0; k < 8; k++)
+         ptn[k] = sseg.h2s((i + k) & 0xf);
+      MEASURE("SsegCore::write_8ptn", sseg.write_8ptn(ptn));
+      MEASURE("TimerCore::read_tick", t1 = timer.read_tick());
+   }
+   check(t1 > t0, "timer counts");
+   MEASURE("TimerCore::sleep 10 us", timer.sleep(10));
+   // periodic alarm on irq line 1, every 1000 clk
+   timer.set_alarm(timer.read_tick() + 1000, 1000, 1);
+   for (int i = 0; i < 5; i++) {
+      while (!cosim_irq(1))
+         cosim_idle(1);
+      t1 = cosim_cycles();
+      if (i > 0)
+         record("  alarm irq period", t1 - t0, 0);
+      t0 = t1;
+      timer.ack_alarm();
+   }
+   timer.cancel_alarm();
+   check(!cosim_irq(1), "alarm irq cleared");
+}
+
+static void bench_uart() {
+   const char *msg = "cosim uart 0123456789\n\r";
+   char buf[FMT_BUF_LEN];
+   uint64_t t0;
+   std::string expect;
+
+   MEASURE("UartCore::set_baud_rate", uart.set_baud_rate(921600));
+   uart.tx_flush();
+   t0 = cosim_cycles();
+   for (int i = 0; i < 4; i++) {
+      MEASURE("UartCore::disp(str) 23 B", uart.disp(msg));
+      MEASURE("UartCore::disp(int)", uart.disp(-12345 * i));
+      MEASURE("UartCore::disp_fixed", uart.disp_fixed(1234 * i, 3));
+      MEASURE("UartCore::tx_poll", uart.tx_poll());
+      expect += msg;
+      expect.append(buf, fmt_int(buf, -12345 * i, 10, 0));
+      expect.append(buf, fmt_fixed(buf, 1234 * i, 3));
+   }
+   // wait until the last byte has left the tx pin
+   while (cosim_uart_text().size() < expect.size()
+         && cosim_cycles() - t0 < 50000000ULL)
+      cosim_idle(1000);
+   printf("uart: %zu bytes on the tx pin in %llu clk at %d baud\n",
+         cosim_uart_text().size(), (unsigned long long) (cosim_cycles() - t0),
+         uart.get_baud_rate());
+   check(cosim_uart_text() == expect, "uart text on the tx pin");
+}
+
+/**********************************************************************
+ * i2c and ToF samples
+ *********************************************************************/
+static void bench_i2c(I2cCore *i2c) {
+   static const int freqs[] = {100000, 400000, 1000000};
+   static char names[3][3][40];   // Stat keeps the name pointers
+   uint8_t id = 0, cfg[2] = {0x04, 0x6e}, res[2];
+   int ack;
+
+   for (int f = 0; f < 3; f++) {
+      snprintf(names[f][0], 40, "I2cCore::read_block 1 B %dK", freqs[f] / 1000);
+      snprintf(names[f][1], 40, "I2cCore::write_block 2 B %dK", freqs[f] / 1000);
+      snprintf(names[f][2], 40, "I2cCore::read_block 2 B %dK", freqs[f] / 1000);
+      i2c->set_freq(freqs[f]);
+      for (int i = 0; i < 4; i++) {
+         MEASURE(names[f][0], ack = i2c->read_block(TOF_DEV, 0x00, &id, 1));
+         check(ack == 0 && id == EmuIsl29501::DEV_ID, "device id");
+         MEASURE(names[f][1], i2c->write_block(TOF_DEV, 0x10, cfg, 2));
+         MEASURE(names[f][2], i2c->read_block(TOF_DEV, 0xd1, res, 2));
+      }
+   }
+}
+
+/* single-shot samples; data ready from 0x69 (irq = 0) or the irq line */
+static void bench_sample(I2cCore *i2c, Isl29501 *tof, int irq, int num) {
+   const char *name = (irq) ? "sample: single shot, irq" :
+                              "sample: single shot, poll 0x69";
+   const char *wait = (irq) ? "  conversion wait (irq)" :
+                              "  conversion wait (poll)";
+   uint8_t stat, res[2];
+   uint64_t t0, a0, t1;
+   uint32_t cap;
+
+   stat_of(name);      // total listed above its parts
+   tof->write_reg(0x60, (irq) ? 0x01 : 0x00);   // data-ready irq enable
+   capture_select(TimerCore::CAP_TOF_IRQ);
+   for (int i = 0; i < num; i++) {
+      t0 = cosim_cycles();
+      a0 = cosim_accesses();
+      MEASURE("  Isl29501::command (start)", tof->command(0x49));
+      t1 = cosim_cycles();
+      if (irq) {
+         uint32_t t_start = (uint32_t) now_tick();
+         while (!cosim_irq(0))
+            cosim_idle(1);
+         cosim_idle(4);      // irq synchronizers (INTC and timer capture)
+         MEASURE("  capture_tick", cap = capture_tick());
+         check((int32_t) (cap - t_start) > 0
+               && (int32_t) ((uint32_t) now_tick() - cap) > 0, "irq capture");
+         i2c->read_block(TOF_DEV, 0x69, &stat, 1);   // releases the irq
+      } else {
+         do {
+            MEASURE("  I2cCore::read_block 0x69",
+                  i2c->read_block(TOF_DEV, 0x69, &stat, 1));
+         } while (!(stat & 0x01));
+      }
+      record(wait, cosim_cycles() - t1, 0);
+      MEASURE("  I2cCore::read_block 0xd1 2 B",
+            i2c->read_block(TOF_DEV, 0xd1, res, 2));
+      record(name, cosim_cycles() - t0, cosim_accesses() - a0);
+      check(res[0] != 0 || res[1] != 0, "sample value");
+   }
+}
+
+/* acquisition engine: the i2c sequence runs in hardware */
+static void bench_acq(int num) {
+   TofAcqCore acq(get_slot_addr(BRIDGE_BASE, S14_TOF_ACQ));
+   tof_sample_t s[16];
+   int n = 0, k;
+   uint64_t t0 = cosim_cycles(), t1, a1;
+
+   acq.set_period(2000);
+   acq.set_conv_wait(1200);
+   capture_select(TimerCore::CAP_ACQ_START);
+   acq.enable();
+   while (n < num && cosim_cycles() - t0 < 100000000ULL) {
+      if (acq.count() == 0) {
+         cosim_idle(100);
+         continue;
+      }
+      t1 = cosim_cycles();
+      a1 = cosim_accesses();
+      MEASURE("TofAcqCore::read_samples", k = acq.read_samples(s + n, num - n));
+      for (int i = n; i < n + k; i++) {
+         // cpu cost per sample; the i2c sequence runs in hardware
+         record("sample: acquisition engine", (cosim_cycles() - t1) / k,
+               (cosim_accesses() - a1) / k);
+         check(s[i].nack == 0 && s[i].raw != 0, "engine sample");
+         if (i > 0)
+            record("  sample period (time stamps)", s[i].tick - s[i - 1].tick, 0);
+      }
+      // newest sample start captured by the timer (no start since)
+      check(capture_tick() == s[n + k - 1].tick, "engine start capture");
+      n += k;
+   }
+   acq.disable();
+   check(n == num, "engine sample count");
+}
+
+int main(int argc, char **argv) {
+   I2cCore i2c(get_slot_addr(BRIDGE_BASE, S4_USER));
+   Isl29501 tof(&i2c, TOF_DEV);
+
+   Verilated::commandArgs(argc, argv);
+   emu_attach_pmod_tof(S4_USER, 0);
+   bench_timer_gpio();
+   bench_uart();
+   bench_i2c(&i2c);
+   i2c.set_freq(1000000);
+   bench_sample(&i2c, &tof, 0, 4);
+   bench_sample(&i2c, &tof, 1, 4);
+   bench_acq(8);
+   printf("clocks per MMIO access: %s (COSIM_IO_CYCLES), total %llu clk\n",
+         getenv("COSIM_IO_CYCLES") ? getenv("COSIM_IO_CYCLES") : "8",
+         (unsigned long long) cosim_cycles());
+   report();
+   if (fails) {
+      printf("FAIL: %d checks\n", fails);
+      return 1;
+   }
+   printf("PASS\n");
+   return 0;
+}
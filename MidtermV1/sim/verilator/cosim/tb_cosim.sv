@@ -0,0 +1,98 @@
+// Verilator co-simulation top: MCS io bus -> chu_mcs_bridge -> mmio_sys_sampler
+// * the io bus is driven by the bus-functional model in cosim.cpp;
+//   the MicroBlaze MCS itself is not simulated
+// * ToF i2c bus (slot 4): pulled up; the C++ slave model pulls sda low
+//   through tof_sda_low and sees the lines on tof_scl_o/tof_sda_o
+// * temperature i2c bus (slot 10), ps2 and spi: pulled up, no device
+// * xadc_fpro is replaced by xadc_stub.sv (no XADC primitive model)
+
+module tb_cosim
+   (
+    input  logic clk,
+    input  logic reset,
+    // MCS io bus
+    input  logic io_addr_strobe,
+    input  logic io_read_strobe,
+    input  logic io_write_strobe,
+    input  logic [3:0] io_byte_enable,
+    input  logic [31:0] io_address,
+    input  logic [31:0] io_write_data,
+    output logic [31:0] io_read_data,
+    output logic io_ready,
+    // board i/o
+    input  logic [15:0] sw,
+    output logic [15:0] led,
+    input  logic [4:0] btn,
+    input  logic rx,
+    output logic tx,
+    output logic [7:0] an,
+    output logic [7:0] sseg,
+    // ToF i2c bus
+    input  logic tof_sda_low,
+    output logic tof_scl_o,
+    output logic tof_sda_o,
+    // system timer alarm (INTC_Interrupt[1] on the board)
+    output logic timer_irq,
+    // ToF data-ready irq from the C++ device model (timer capture)
+    input  logic tof_irq_n
+   );
+
+   // declaration
+   logic fp_mmio_cs;
+   logic fp_wr;
+   logic fp_rd;
+   logic [20:0] fp_addr;
+   logic [31:0] fp_wr_data;
+   logic [31:0] fp_rd_data;
+   tri tof_i2c_scl, tof_i2c_sda;
+   tri tmp_i2c_scl, tmp_i2c_sda;
+   tri ps2d, ps2c;
+
+   // body
+   pullup (tof_i2c_scl);
+   pullup (tof_i2c_sda);
+   pullup (tmp_i2c_scl);
+   pullup (tmp_i2c_sda);
+   pullup (ps2d);
+   pullup (ps2c);
+   assign tof_i2c_sda = (tof_sda_low) ? 1'b0 : 1'bz;
+   assign tof_scl_o = tof_i2c_scl;
+   assign tof_sda_o = tof_i2c_sda;
+
+   chu_mcs_bridge #(.BRG_BASE(32'hc000_0000)) b_unit (.*, .fp_video_cs());
+
+   mmio_sys_sampler #(.N_SW(16),.N_LED(16)) mmio_unit (
+    .clk(clk),
+    .reset(reset),
+    .mmio_cs(fp_mmio_cs),
+    .mmio_wr(fp_wr),
+    .mmio_rd(fp_rd),
+    .mmio_addr(fp_addr),
+    .mmio_wr_data(fp_wr_data),
+    .mmio_rd_data(fp_rd_data),
+    .sw(sw),
+    .led(led),
+    .rx(rx),
+    .tx(tx),
+    .adc_p(4'b0000),
+    .adc_n(4'b0000),
+    .pwm(),
+    .btn(btn),
+    .an(an),
+    .sseg(sseg),
+    .acl_sclk(),
+    .acl_mosi(),
+    .acl_miso(1'b0),
+    .acl_ss(),
+    .tmp_i2c_scl(tmp_i2c_scl),
+    .tmp_i2c_sda(tmp_i2c_sda),
+    .tof_i2c_scl(tof_i2c_scl),
+    .tof_i2c_sda(tof_i2c_sda),
+    .ps2d(ps2d),
+    .ps2c(ps2c),
+    .timer_irq(timer_irq),
+    .tof_irq_n(tof_irq_n),
+    .ddfs_sq_wave(),
+    .pdm()
+   );
+endmodule
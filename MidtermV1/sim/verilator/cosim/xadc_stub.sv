@@ -0,0 +1,80 @@
+// Simulation stand-in for the xadc_fpro wizard core (XADC primitive)
+// * same ports as xadc_fpro.sv; analog inputs are ignored
+// * sequence mode: one end of conversion every CONV_CLKS clocks over
+//   the channels of the real sequencer (temp, vccint, aux 2/3/10/11)
+// * drdy/do_out answer a DRP read one clock after den
+// * fixed codes: 25 C, 1.0 V vccint, 0.5 V on every aux input
+
+module xadc_fpro
+   #(parameter CONV_CLKS = 104)   // about 1 MSPS at dclk 100 MHz
+   (
+    input  logic [6:0] daddr_in,
+    input  logic dclk_in,
+    input  logic den_in,
+    input  logic [15:0] di_in,
+    input  logic dwe_in,
+    input  logic reset_in,
+    input  logic vauxp2, vauxn2,
+    input  logic vauxp3, vauxn3,
+    input  logic vauxp10, vauxn10,
+    input  logic vauxp11, vauxn11,
+    input  logic vp_in, vn_in,
+    output logic busy_out,
+    output logic [4:0] channel_out,
+    output logic [15:0] do_out,
+    output logic drdy_out,
+    output logic eoc_out,
+    output logic eos_out,
+    output logic alarm_out
+   );
+
+   // declaration
+   logic [7:0] cnt_reg;
+   logic [2:0] seq_reg;
+   logic [4:0] chan;
+   logic drdy_reg;
+   logic [15:0] do_reg;
+
+   // body
+   always_comb
+      case (seq_reg)
+         3'd0:    chan = 5'b00000;   // temperature
+         3'd1:    chan = 5'b00001;   // vccint
+         3'd2:    chan = 5'b10010;   // vaux2
+         3'd3:    chan = 5'b10011;   // vaux3
+         3'd4:    chan = 5'b11010;   // vaux10
+         default: chan = 5'b11011;   // vaux11
+      endcase
+
+   always_ff @(posedge dclk_in, posedge reset_in)
+      if (reset_in) begin
+         cnt_reg <= 0;
+         seq_reg <= 0;
+         drdy_reg <= 1'b0;
+         do_reg <= 16'h0000;
+      end
+      else begin
+         if (cnt_reg == CONV_CLKS - 1)
+            cnt_reg <= 0;
+         else
+            cnt_reg <= cnt_reg + 1;
+         // next channel once the result has been read out
+         if (cnt_reg == 1)
+            seq_reg <= (seq_reg == 3'd5) ? 3'd0 : seq_reg + 1;
+         drdy_reg <= den_in;
+         if (den_in)
+            case (daddr_in[4:0])
+               5'b00000: do_reg <= 16'h9773;   // 25 C
+               5'b00001: do_reg <= 16'h5555;   // 1.0 V
+               default:  do_reg <= 16'h8000;   // 0.5 V
+            endcase
+      end
+
+   assign eoc_out = (cnt_reg == CONV_CLKS - 1);
+   assign eos_out = eoc_out && (seq_reg == 3'd5);
+   assign channel_out = chan;
+   assign busy_out = 1'b0;
+   assign alarm_out = 1'b0;
+   assign do_out = do_reg;
+   assign drdy_out = drdy_reg;
+endmodule
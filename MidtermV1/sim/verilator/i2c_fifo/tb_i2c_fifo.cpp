@@ -0,0 +1,188 @@
+/*****************************************************************//**
+ * @file tb_i2c_fifo.cpp
+ *
+ * @brief Verilator testbench for the chu_i2c_core command FIFOs
+ *
+ * Description:
+ * - the slot interface is driven like the MicroBlaze MCS io bus:
+ *   every MMIO access is followed by IO_GAP idle clocks
+ *   (bus latency plus the driver instructions around it)
+ * - the same write transaction is issued twice:
+ *   - "polled": original driver, ready() polled before/after each byte
+ *   - "fifo":   whole transaction pushed into the command FIFO
+ * - scl rising edges are time-stamped; the gap between the last
+ *   (ack) clock of a byte and the first clock of the next byte is
+ *   reported as excess over one nominal scl period
+ * - the fifo run must show no gap beyond the master's own
+ *   data_end/hold phase (one quarter period plus a few clocks)
+ *
+ *********************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+#include "Vtb_i2c_fifo.h"
+#include "verilated.h"
+
+// register map / commands (same as i2c_core.h)
+enum { RD_REG = 0, DVSR_REG = 1, WR_REG = 2, RX_FIFO_REG = 3 };
+enum {
+   I2C_START_CMD = 0x00 << 8,
+   I2C_WR_CMD = 0x01 << 8,
+   I2C_RD_CMD = 0x02 << 8,
+   I2C_STOP_CMD = 0x03 << 8,
+   I2C_RESTART_CMD = 0x04 << 8,
+   I2C_LOG_FLAG = 0x01 << 11
+};
+
+static const int IO_GAP = 8;     // cpu clocks per MMIO access
+static const int DVSR = 250;     // quarter scl period (100 kHz @ 100 MHz)
+
+static Vtb_i2c_fifo *top;
+static uint64_t cycle;
+static int scl_last;
+static std::vector<uint64_t> scl_rise;
+
+/* one system clock */
+static void tick() {
+   top->clk = 0;
+   top->eval();
+   top->clk = 1;
+   top->eval();
+   cycle++;
+   if (top->scl_o && !scl_last)
+      scl_rise.push_back(cycle);
+   scl_last = top->scl_o;
+}
+
+static void idle(int n) {
+   for (int i = 0; i < n; i++)
+      tick();
+}
+
+static void bus_write(int addr, uint32_t data) {
+   top->cs = 1;
+   top->write = 1;
+   top->addr = addr;
+   top->wr_data = data;
+   tick();
+   top->cs = 0;
+   top->write = 0;
+   idle(IO_GAP - 1);
+}
+
+static uint32_t bus_read(int addr) {
+   uint32_t data;
+
+   top->cs = 1;
+   top->read = 1;
+   top->addr = addr;
+   top->eval();
+   data = top->rd_data;
+   tick();
+   top->cs = 0;
+   top->read = 0;
+   idle(IO_GAP - 1);
+   return data;
+}
+
+static int ready() {
+   return (bus_read(RD_REG) >> 8) & 0x01;
+}
+
+/* original driver: poll ready before and after every byte */
+static void polled_write(uint8_t dev, const uint8_t *bytes, int num) {
+   while (!ready()) {
+   }
+   bus_write(WR_REG, I2C_START_CMD);
+   for (int i = -1; i < num; i++) {
+      uint8_t b = (i < 0) ? (dev << 1) : bytes[i];
+      while (!ready()) {
+      }
+      bus_write(WR_REG, I2C_WR_CMD | b);
+      while (!ready()) {
+      }
+      bus_read(RD_REG);    // ack
+   }
+   while (!ready()) {
+   }
+   bus_write(WR_REG, I2C_STOP_CMD);
+   while (!ready()) {
+   }
+}
+
+/* fifo driver: push the whole transaction, then collect results */
+static int fifo_write(uint8_t dev, const uint8_t *bytes, int num) {
+   int n = 0;
+
+   bus_write(WR_REG, I2C_START_CMD);
+   bus_write(WR_REG, I2C_WR_CMD | I2C_LOG_FLAG | (dev << 1));
+   for (int i = 0; i < num; i++)
+      bus_write(WR_REG, I2C_WR_CMD | I2C_LOG_FLAG | bytes[i]);
+   bus_write(WR_REG, I2C_STOP_CMD);
+   while (n < num + 1) {
+      if (!(bus_read(RX_FIFO_REG) & 0x200)) {
+         bus_write(RX_FIFO_REG, 0);
+         n++;
+      }
+   }
+   while (!ready()) {
+   }
+   return n;
+}
+
+/* excess of inter-byte gaps over one scl period; returns max */
+static uint64_t report(const char *name, uint64_t t0, int nbytes) {
+   uint64_t period = 4 * DVSR;
+   uint64_t max_excess = 0, sum = 0;
+
+   printf("%-7s", name);
+   for (int k = 1; k < nbytes; k++) {
+      size_t last = 9 * k - 1;          // ack clock of byte k-1
+      uint64_t gap = scl_rise[last + 1] - scl_rise[last];
+      uint64_t excess = (gap > period) ? gap - period : 0;
+      printf(" %5llu", (unsigned long long) excess);
+      sum += excess;
+      if (excess > max_excess)
+         max_excess = excess;
+   }
+   printf("  | total %llu clk, stall %llu clk\n",
+         (unsigned long long) (cycle - t0), (unsigned long long) sum);
+   return max_excess;
+}
+
+int main(int argc, char **argv) {
+   const uint8_t data[4] = {0x10, 0x04, 0x6e, 0x71};
+   const int nbytes = 5;    // device id + 4 data bytes
+   uint64_t t0, polled_max, fifo_max;
+   int n;
+
+   Verilated::commandArgs(argc, argv);
+   top = new Vtb_i2c_fifo;
+   top->reset = 1;
+   idle(4);
+   top->reset = 0;
+   idle(4);
+   bus_write(DVSR_REG, DVSR);
+
+   printf("inter-byte excess over one scl period (clk), IO_GAP=%d\n", IO_GAP);
+   scl_rise.clear();
+   t0 = cycle;
+   polled_write(0x57, data, 4);
+   polled_max = report("polled", t0, nbytes);
+
+   scl_rise.clear();
+   t0 = cycle;
+   n = fifo_write(0x57, data, 4);
+   fifo_max = report("fifo", t0, nbytes);
+
+   delete top;
+   // hardware minimum: data_end (1 quarter) + hold/FIFO handoff
+   if (n != nbytes || fifo_max > (uint64_t) DVSR + 4 || fifo_max >= polled_max) {
+      printf("FAIL: results %d, fifo max excess %llu\n", n,
+            (unsigned long long) fifo_max);
+      return 1;
+   }
+   printf("PASS\n");
+   return 0;
+}
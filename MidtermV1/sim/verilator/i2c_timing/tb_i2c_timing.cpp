@@ -0,0 +1,133 @@
+/*****************************************************************//**
+ * @file tb_i2c_timing.cpp
+ *
+ * @brief Verilator testbench for i2c_master fast-mode timing and
+ *        slave clock stretching
+ *
+ * Description:
+ * - a start, 2 write bytes and a stop are issued at the divisor that
+ *   I2cCore::set_freq() selects for 100K, 400K and 1M Hz
+ * - scl low/high phases of the data bytes are measured and checked
+ *   against the bus-mode minimums (tLOW/tHIGH) and the requested rate
+ * - the 1M Hz run is repeated with a slave that stretches every low
+ *   phase; the master must wait and still give a full high phase
+ *
+ *********************************************************************/
+
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+#include "Vtb_i2c_timing.h"
+#include "verilated.h"
+
+enum { START_CMD = 0, WR_CMD = 1, RD_CMD = 2, STOP_CMD = 3 };
+
+static const int CLK_MHZ = 100;     // system clock (SYS_CLK_FREQ)
+
+static Vtb_i2c_timing *top;
+static uint64_t cycle;
+static int scl_last;
+static std::vector<uint64_t> scl_edge;   // alternating fall/rise times
+
+/* one system clock */
+static void tick() {
+   top->clk = 0;
+   top->eval();
+   top->clk = 1;
+   top->eval();
+   cycle++;
+   if (top->scl_o != scl_last)
+      scl_edge.push_back(cycle);
+   scl_last = top->scl_o;
+}
+
+static void wait_ready() {
+   do {
+      tick();
+   } while (!top->ready);
+}
+
+static void issue(int cmd, int din) {
+   wait_ready();
+   top->cmd = cmd;
+   top->din = din;
+   top->wr_i2c = 1;
+   tick();
+   top->wr_i2c = 0;
+   tick();
+}
+
+/* same rule as I2cCore::set_freq() */
+static int dvsr_of(int freq) {
+   int dvsr, tlow_ns, min_dvsr;
+
+   dvsr = (CLK_MHZ * 1000000 + 4 * freq - 1) / (4 * freq);
+   tlow_ns = (freq <= 100000) ? 4700 : (freq <= 400000) ? 1300 : 500;
+   min_dvsr = (tlow_ns * CLK_MHZ + 1999) / 2000;
+   return (dvsr < min_dvsr) ? min_dvsr : dvsr;
+}
+
+/* run one transfer; returns 0 if timing holds */
+static int run(int freq, int stretch) {
+   int dvsr = dvsr_of(freq);
+   int tlow_ns = (freq <= 100000) ? 4700 : (freq <= 400000) ? 1300 : 500;
+   int thigh_ns = (freq <= 100000) ? 4000 : (freq <= 400000) ? 600 : 260;
+   uint64_t min_low = ~0ull, min_high = ~0ull;
+   double f;
+   int err = 0;
+
+   top->dvsr = dvsr;
+   top->stretch = stretch;
+   issue(START_CMD, 0);
+   scl_edge.clear();
+   issue(WR_CMD, 0xa5);
+   issue(WR_CMD, 0x5a);
+   wait_ready();
+   issue(STOP_CMD, 0);
+   wait_ready();
+   // edge 0: scl falls after start; then rise/fall per data clock;
+   // the first low phase (start hold) is skipped
+   for (size_t i = 1; i + 1 < scl_edge.size(); i++) {
+      uint64_t d = scl_edge[i + 1] - scl_edge[i];
+      if (i % 2)
+         min_high = (d < min_high) ? d : min_high;
+      else
+         min_low = (d < min_low) ? d : min_low;
+   }
+   f = 1e6 * CLK_MHZ / (double) (min_low + min_high);
+   printf("%7d Hz dvsr %3d stretch %3d: tLOW %6.0f ns, tHIGH %6.0f ns, fscl %7.0f Hz",
+         freq, dvsr, stretch, min_low * 1e3 / CLK_MHZ, min_high * 1e3 / CLK_MHZ, f);
+   if (min_low * 1000 < (uint64_t) tlow_ns * CLK_MHZ)
+      err = 1;
+   if (min_high * 1000 < (uint64_t) thigh_ns * CLK_MHZ)
+      err = 1;
+   if (min_high < (uint64_t) 2 * dvsr)    // stretched high phase cut short
+      err = 1;
+   if (stretch == 0 && f > freq)
+      err = 1;
+   if (stretch > 0 && min_low < (uint64_t) stretch)
+      err = 1;
+   printf("  %s\n", err ? "FAIL" : "ok");
+   return err;
+}
+
+int main(int argc, char **argv) {
+   int err = 0;
+
+   Verilated::commandArgs(argc, argv);
+   top = new Vtb_i2c_timing;
+   scl_last = 1;
+   top->reset = 1;
+   tick();
+   tick();
+   top->reset = 0;
+   tick();
+
+   err |= run(100000, 0);
+   err |= run(400000, 0);
+   err |= run(1000000, 0);
+   err |= run(1000000, 300);    // 3 us stretch per low phase
+   delete top;
+   printf("%s\n", err ? "FAIL" : "PASS");
+   return err;
+}
@@ -0,0 +1,50 @@
+// Verilator testbench top for i2c_master bus timing
+// * master command port driven from tb_i2c_timing.cpp
+// * scl/sda pulled up; slave model only stretches scl:
+//   after each scl falling edge it holds scl low for "stretch" clocks
+// * scl/sda copied to plain outputs for edge timing in C++
+
+module tb_i2c_timing
+   (
+    input  logic clk,
+    input  logic reset,
+    // master command port
+    input  logic [7:0] din,
+    input  logic [15:0] dvsr,
+    input  logic [2:0] cmd,
+    input  logic wr_i2c,
+    output logic ready, done_tick, ack,
+    output logic [7:0] dout,
+    // slave clock stretch (# clocks after each scl falling edge)
+    input  logic [15:0] stretch,
+    // observed bus lines
+    output logic scl_o,
+    output logic sda_o
+   );
+
+   // declaration
+   tri scl, sda;
+   logic [15:0] hold_reg;
+   logic scl_d_reg;
+
+   // body
+   pullup (scl);
+   pullup (sda);
+   i2c_master i2c_unit (.*);
+   // stretching slave
+   always_ff @(posedge clk, posedge reset)
+      if (reset) begin
+         hold_reg <= 0;
+         scl_d_reg <= 1'b1;
+      end
+      else begin
+         scl_d_reg <= scl;
+         if (scl_d_reg && !scl)
+            hold_reg <= stretch;
+         else if (hold_reg != 0)
+            hold_reg <= hold_reg - 1;
+      end
+   assign scl = (hold_reg != 0) ? 1'b0 : 1'bz;
+   assign scl_o = scl;
+   assign sda_o = sda;
+endmodule